@@ -31,13 +31,25 @@ SOURCES += \
     src/pacman.cpp \
     src/pacmansettings.cpp \
     src/appsettings.cpp \
+    src/gzipstream.cpp \
+    src/transactionsimulator.cpp \
+    src/packages-view/aurarchive.cpp \
+    src/packages-view/aurcache.cpp \
+    src/packages-view/aurclient.cpp \
     src/packages-view/depend.cpp \
+    src/packages-view/dependencygraph.cpp \
+    src/packages-view/fileownersindex.cpp \
     src/packages-view/package.cpp \
     src/packages-view/packagesmodel.cpp \
     src/packages-view/packagesview.cpp \
+    src/packages-view/packagesindex.cpp \
+    src/packages-view/packagessnapshot.cpp \
+    src/packages-view/packagestable.cpp \
+    src/packages-view/packageversion.cpp \
     src/files-view/file.cpp \
     src/files-view/filesmodel.cpp \
     src/files-view/filesview.cpp \
+    src/files-view/filesverifier.cpp \
     src/tasks-view/task.cpp \
     src/tasks-view/tasksmodel.cpp \
     src/tasks-view/tasksview.cpp
@@ -52,13 +64,25 @@ HEADERS += \
     src/pacman.h \
     src/pacmansettings.h \
     src/appsettings.h \
+    src/gzipstream.h \
+    src/transactionsimulator.h \
+    src/packages-view/aurarchive.h \
+    src/packages-view/aurcache.h \
+    src/packages-view/aurclient.h \
     src/packages-view/depend.h \
+    src/packages-view/dependencygraph.h \
+    src/packages-view/fileownersindex.h \
     src/packages-view/package.h \
     src/packages-view/packagesmodel.h \
     src/packages-view/packagesview.h \
+    src/packages-view/packagesindex.h \
+    src/packages-view/packagessnapshot.h \
+    src/packages-view/packagestable.h \
+    src/packages-view/packageversion.h \
     src/files-view/file.h \
     src/files-view/filesmodel.h \
     src/files-view/filesview.h \
+    src/files-view/filesverifier.h \
     src/tasks-view/task.h \
     src/tasks-view/tasksmodel.h \
     src/tasks-view/tasksview.h
@@ -68,7 +92,7 @@ FORMS += \
     src/tasksdialog.ui \
     src/settingsdialog.ui
 
-LIBS += -lalpm -ltbb
+LIBS += -lalpm -ltbb -lz
 
 # Rules for deployment
 bin.path = /usr/bin
@@ -242,6 +242,16 @@ QString AppSettings::defaultPacmanTool()
     return QStringLiteral("sudo pacman");
 }
 
+bool AppSettings::isOptdependsRequired() const
+{
+    return value("OptdependsRequired", defaultIsOptdependsRequired()).toBool();
+}
+
+void AppSettings::setOptdependsRequired(bool required)
+{
+    setValue("OptdependsRequired", required);
+}
+
 AutosyncTimer::AutosyncType AppSettings::autosyncType() const
 {
     return value("AutosyncType", defaultAutosyncType()).value<AutosyncTimer::AutosyncType>();
@@ -390,6 +400,26 @@ void AppSettings::setProxyPassword(const QString &password)
     setValue("Connection/ProxyPassword", password);
 }
 
+bool AppSettings::isOfflineAurSearchEnabled() const
+{
+    return value("Connection/OfflineAurSearch", defaultIsOfflineAurSearchEnabled()).toBool();
+}
+
+void AppSettings::setOfflineAurSearchEnabled(bool enabled)
+{
+    setValue("Connection/OfflineAurSearch", enabled);
+}
+
+QString AppSettings::aurArchiveFile() const
+{
+    return value("Connection/AurArchiveFile").toString();
+}
+
+void AppSettings::setAurArchiveFile(const QString &fileName)
+{
+    setValue("Connection/AurArchiveFile", fileName);
+}
+
 QString AppSettings::changeModeShortcut() const
 {
     return value("Shortcuts/ChangeMode", defaultChangeModeShortcut()).toString();
@@ -62,6 +62,11 @@ public:
     void setPacmanTool(const QString &programName);
     static QString defaultPacmanTool();
 
+    bool isOptdependsRequired() const;
+    void setOptdependsRequired(bool required);
+    static constexpr bool defaultIsOptdependsRequired()
+    { return true; }
+
     AutosyncTimer::AutosyncType autosyncType() const;
     void setAutosyncType(AutosyncTimer::AutosyncType type);
     static constexpr AutosyncTimer::AutosyncType defaultAutosyncType()
@@ -103,6 +108,14 @@ public:
     QString proxyPassword() const;
     void setProxyPassword(const QString &password);
 
+    bool isOfflineAurSearchEnabled() const;
+    void setOfflineAurSearchEnabled(bool enabled);
+    static constexpr bool defaultIsOfflineAurSearchEnabled()
+    { return false; }
+
+    QString aurArchiveFile() const;
+    void setAurArchiveFile(const QString &fileName);
+
     // Shortcuts
     QString changeModeShortcut() const;
     void setChangeModeShortcut(const QString &shortcut);
@@ -2,47 +2,20 @@
 
 #include <QMimeDatabase>
 #include <QDir>
+#include <QFileInfo>
 
 File::File()
 {
     m_nameColumn = QStringLiteral("Name");
     m_sizeColumn = QStringLiteral("Size");
     m_typeColumn = QStringLiteral("Type");
-    m_info.setFile(QDir::rootPath());
+    m_path = QDir::rootPath();
 }
 
 File::File(const QString &path, File *parent) :
-    m_info(path)
+    m_nameColumn(path.mid(path.lastIndexOf('/') + 1)),
+    m_path(path)
 {
-    m_nameColumn = m_info.fileName();
-    if (!m_info.exists() && parent->isReadable()) {
-        m_icon = QIcon::fromTheme("dialog-error");
-        m_typeColumn = QStringLiteral("Missing");
-        m_missing = true;
-    } else if (m_info.isFile()) {
-        const QMimeDatabase mimeDatabase;
-        const QMimeType type = mimeDatabase.mimeTypeForFile(m_info);
-
-        if (m_info.isReadable())
-            m_icon = QIcon::fromTheme(type.iconName());
-        else
-            m_icon = QIcon::fromTheme("lock");
-
-        m_sizeColumn = QString::number(m_info.size());
-        m_typeColumn = type.name();
-    } else if (m_info.isDir()) {
-        if (m_info.isReadable())
-            m_icon = QIcon::fromTheme("folder");
-        else
-            m_icon = QIcon::fromTheme("lock");
-
-        m_typeColumn = QStringLiteral("Folder");
-    } else {
-        // No access to read any information
-        m_typeColumn = QStringLiteral("No access");
-        m_icon = QIcon::fromTheme("lock");
-    }
-
     parent->addChild(this);
 }
 
@@ -53,10 +26,7 @@ File::~File()
 
 int File::row() const
 {
-    if (m_parent != nullptr)
-        return m_parent->m_children.indexOf(const_cast<File *>(this));
-
-    return 0;
+    return m_row;
 }
 
 QString File::text(int column) const
@@ -67,6 +37,8 @@ QString File::text(int column) const
     case 1:
         return m_sizeColumn;
     case 2:
+        if (!m_problem.isEmpty())
+            return m_problem;
         return m_typeColumn;
     default:
         qFatal("Unknown column");
@@ -81,13 +53,81 @@ File *File::parent() const
 void File::addChild(File *child)
 {
     child->m_parent = this;
+    child->m_row = m_children.size();
     m_children.append(child);
+    m_childrenIndex.insert(child->name(), child);
 }
 
 void File::removeChildren()
 {
     qDeleteAll(m_children);
     m_children.clear();
+    m_childrenIndex.clear();
+}
+
+File::Attributes File::readAttributes(const QString &path)
+{
+    const QFileInfo info(path);
+    Attributes attributes;
+    attributes.exists = info.exists();
+    attributes.file = info.isFile();
+    attributes.dir = info.isDir();
+    attributes.readable = info.isReadable();
+
+    if (!attributes.exists) {
+        // File is missing only if it could be seen in the parent folder
+        attributes.missing = QFileInfo(info.path()).isReadable();
+    } else if (attributes.file) {
+        // Mime database could read file content, so it also happens here
+        const QMimeDatabase mimeDatabase;
+        const QMimeType type = mimeDatabase.mimeTypeForFile(info);
+        attributes.size = info.size();
+        attributes.mimeType = type.name();
+        attributes.iconName = type.iconName();
+    }
+
+    return attributes;
+}
+
+// Icons can be created only in the GUI thread
+void File::setAttributes(const Attributes &attributes)
+{
+    m_attributes = attributes;
+    m_attributesLoaded = true;
+
+    if (attributes.missing) {
+        m_icon = QIcon::fromTheme("dialog-error");
+        m_typeColumn = QStringLiteral("Missing");
+    } else if (attributes.file) {
+        if (attributes.readable)
+            m_icon = QIcon::fromTheme(attributes.iconName);
+        else
+            m_icon = QIcon::fromTheme("lock");
+
+        m_sizeColumn = QString::number(attributes.size);
+        m_typeColumn = attributes.mimeType;
+    } else if (attributes.dir) {
+        if (attributes.readable)
+            m_icon = QIcon::fromTheme("folder");
+        else
+            m_icon = QIcon::fromTheme("lock");
+
+        m_typeColumn = QStringLiteral("Folder");
+    } else {
+        // No access to read any information
+        m_typeColumn = QStringLiteral("No access");
+        m_icon = QIcon::fromTheme("lock");
+    }
+}
+
+bool File::isAttributesRequested() const
+{
+    return m_attributesRequested;
+}
+
+void File::setAttributesRequested()
+{
+    m_attributesRequested = true;
 }
 
 QString File::name() const
@@ -102,25 +142,51 @@ QIcon File::icon() const
 
 QString File::path() const
 {
-    return m_info.filePath();
+    return m_path;
 }
 
+// Checked directly if attributes are not loaded yet
 bool File::isFile() const
 {
-    return m_info.isFile();
+    if (!m_attributesLoaded)
+        return QFileInfo(m_path).isFile();
+
+    return m_attributes.file;
 }
 
 bool File::isReadable() const
 {
-    return m_info.isReadable();
+    if (!m_attributesLoaded)
+        return QFileInfo(m_path).isReadable();
+
+    return m_attributes.readable;
 }
 
 bool File::isMissing() const
 {
-    return m_missing;
+    return m_attributes.missing || m_problem == QLatin1String("Missing");
 }
 
-QVector<File *> File::children() const
+QString File::problem() const
+{
+    return m_problem;
+}
+
+// Several problems of one file are displayed together
+void File::setProblem(const QString &problem)
+{
+    if (m_problem.isEmpty())
+        m_problem = problem;
+    else if (!m_problem.contains(problem))
+        m_problem += ", " + problem;
+}
+
+const QVector<File *> &File::children() const
 {
     return m_children;
 }
+
+File *File::child(const QString &name) const
+{
+    return m_childrenIndex.value(name);
+}
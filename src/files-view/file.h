@@ -2,11 +2,23 @@
 #define FILE_H
 
 #include <QIcon>
-#include <QFileInfo>
+#include <QHash>
 
 class File
 {
 public:
+    // Information from filesystem, can be read in any thread
+    struct Attributes {
+        bool exists = false;
+        bool missing = false;
+        bool file = false;
+        bool dir = false;
+        bool readable = false;
+        qint64 size = 0;
+        QString mimeType;
+        QString iconName;
+    };
+
     File();
     File(const QString &path, File *parent);
     ~File();
@@ -16,10 +28,17 @@ public:
     QString text(int column) const;
     File *parent() const;
 
-    QVector<File *> children() const;
+    const QVector<File *> &children() const;
+    File *child(const QString &name) const;
     void addChild(File *child);
     void removeChildren();
 
+    // Attributes are loaded on demand
+    static Attributes readAttributes(const QString &path);
+    void setAttributes(const Attributes &attributes);
+    bool isAttributesRequested() const;
+    void setAttributesRequested();
+
     // Item properties
     QString name() const;
     QIcon icon() const;
@@ -27,17 +46,24 @@ public:
     bool isFile() const;
     bool isReadable() const;
     bool isMissing() const;
+    QString problem() const;
+    void setProblem(const QString &problem);
 
 private:
     File *m_parent = nullptr;
     QVector<File *> m_children;
+    QHash<QString, File *> m_childrenIndex;
+    int m_row = 0;
 
     QString m_nameColumn;
     QString m_sizeColumn;
     QString m_typeColumn;
-    QFileInfo m_info;
+    QString m_path;
     QIcon m_icon;
-    bool m_missing = false;
+    Attributes m_attributes;
+    bool m_attributesRequested = false;
+    bool m_attributesLoaded = false;
+    QString m_problem;
 };
 
 #endif // FILE_H
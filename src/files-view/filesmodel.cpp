@@ -2,15 +2,26 @@
 #include "file.h"
 
 #include <QDir>
+#include <QTimer>
+#include <QtConcurrent>
+
+constexpr int ATTRIBUTES_CHUNK_SIZE = 256;
 
 FilesModel::FilesModel(QObject *parent) :
     QAbstractItemModel(parent)
 {
     m_rootItem = new File;
+
+    // Collect items requested during one painting
+    m_requestTimer = new QTimer(this);
+    m_requestTimer->setSingleShot(true);
+    m_requestTimer->setInterval(0);
+    connect(m_requestTimer, &QTimer::timeout, this, &FilesModel::loadPendingAttributes);
 }
 
 FilesModel::~FilesModel()
 {
+    m_loadingAttributes.waitForFinished();
     delete m_rootItem;
 }
 
@@ -20,6 +31,8 @@ QVariant FilesModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     auto *item = static_cast<File *>(index.internalPointer());
+    if (!item->isAttributesRequested())
+        requestAttributes(item);
 
     switch (role) {
     case Qt::DisplayRole:
@@ -27,7 +40,11 @@ QVariant FilesModel::data(const QModelIndex &index, int role) const
     case Qt::BackgroundRole:
         if (item->isMissing())
             return QColor(255, 0, 0, 127); // Semi-transpared red
+        if (!item->problem().isEmpty())
+            return QColor(255, 165, 0, 127); // Semi-transpared orange
         break;
+    case Qt::ToolTipRole:
+        return item->problem();
     case Qt::DecorationRole:
         if (index.column() == 0)
             return item->icon();
@@ -99,35 +116,123 @@ void FilesModel::setPaths(const QStringList &paths)
 {
     beginResetModel();
     m_rootItem->removeChildren();
-    foreach (const QString &path, paths)
-        addPath(path.split('/', QString::SkipEmptyParts));
+    m_pendingFiles.clear();
+    ++m_generation;
+
+    // Items of the previous path, libalpm sorts files, so its folders are usually shared with the next path
+    QVector<File *> branch;
+    QString previousPath;
+    foreach (const QString &path, paths) {
+        int commonLength = 0;
+        const int maxLength = qMin(path.size(), previousPath.size());
+        while (commonLength < maxLength && path.at(commonLength) == previousPath.at(commonLength))
+            ++commonLength;
+
+        // Reuse folders from the common prefix
+        int depth = 0;
+        int start = 0;
+        for (int end = path.indexOf('/'); end != -1 && end < commonLength && depth < branch.size(); end = path.indexOf('/', start)) {
+            start = end + 1;
+            ++depth;
+        }
+        branch.resize(depth);
+
+        // Find or add the remaining parts
+        File *parentItem = branch.isEmpty() ? m_rootItem : branch.last();
+        while (start < path.size()) {
+            int end = path.indexOf('/', start);
+            if (end == -1)
+                end = path.size();
+
+            if (end != start) {
+                File *item = parentItem->child(path.mid(start, end - start));
+                if (item == nullptr)
+                    item = new File(QDir::separator() + path.left(end), parentItem);
+                branch.append(item);
+                parentItem = item;
+            }
+            start = end + 1;
+        }
+        previousPath = path;
+    }
+
     endResetModel();
 }
 
-void FilesModel::addPath(const QStringList &path)
+void FilesModel::addProblem(const QString &path, const QString &problem)
 {
-    File *lastFound = m_rootItem;
-
-    for (int partIndex = 0; partIndex < path.size(); ++partIndex) {
-        // Search item in tree
-        bool found = false;
-        foreach (File *child, lastFound->children()) {
-            if (child->name() == path.at(partIndex)) {
-                lastFound = child;
-                found = true;
-                break;
+    File *parentItem = m_rootItem;
+    QModelIndex parentIndex;
+    int start = 0;
+    while (start < path.size()) {
+        int end = path.indexOf('/', start);
+        if (end == -1)
+            end = path.size();
+
+        if (end != start) {
+            File *item = parentItem->child(path.mid(start, end - start));
+            if (item == nullptr) {
+                const int row = parentItem->children().size();
+                beginInsertRows(parentIndex, row, row);
+                item = new File(path.left(end), parentItem);
+                endInsertRows();
             }
+            parentItem = item;
+            parentIndex = createIndex(item->row(), 0, item);
         }
+        start = end + 1;
+    }
 
-        // Add a new item
-        if (!found) {
-            // Get item path
-            QString itemPath;
-            for (int i = 0; i <= partIndex; ++i)
-                itemPath.append(QDir::separator() + path.at(i));
+    if (parentItem == m_rootItem)
+        return;
 
-            auto *item = new File(itemPath, lastFound);
-            lastFound = item;
-        }
-    }
+    parentItem->setProblem(problem);
+    emit dataChanged(parentIndex, createIndex(parentItem->row(), columnCount() - 1, parentItem));
+}
+
+void FilesModel::requestAttributes(File *file) const
+{
+    file->setAttributesRequested();
+    m_pendingFiles.append(file);
+    if (!m_requestTimer->isActive())
+        m_requestTimer->start();
+}
+
+void FilesModel::loadPendingAttributes()
+{
+    // Next chunk will be started after the current one
+    if (m_pendingFiles.isEmpty() || m_attributesLoading)
+        return;
+
+    const QVector<File *> files = m_pendingFiles.mid(0, ATTRIBUTES_CHUNK_SIZE);
+    m_pendingFiles.remove(0, files.size());
+
+    QStringList paths;
+    paths.reserve(files.size());
+    for (const File *file : files)
+        paths.append(file->path());
+
+    const int generation = m_generation;
+    m_attributesLoading = true;
+    m_loadingAttributes = QtConcurrent::run([this, files, paths, generation] {
+        QVector<File::Attributes> attributes;
+        attributes.reserve(paths.size());
+        for (const QString &path : paths)
+            attributes.append(File::readAttributes(path));
+
+        QMetaObject::invokeMethod(this, [this, files, attributes, generation] {
+            m_attributesLoading = false;
+
+            // Items could be deleted after changing paths
+            if (generation == m_generation) {
+                for (int i = 0; i < files.size(); ++i) {
+                    File *file = files.at(i);
+                    file->setAttributes(attributes.at(i));
+                    emit dataChanged(createIndex(file->row(), 0, file), createIndex(file->row(), columnCount() - 1, file));
+                }
+            }
+
+            loadPendingAttributes();
+        }, Qt::QueuedConnection);
+    });
 }
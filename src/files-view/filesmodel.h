@@ -2,8 +2,10 @@
 #define FILESMODEL_H
 
 #include <QAbstractItemModel>
+#include <QFuture>
 
 class File;
+class QTimer;
 
 class FilesModel : public QAbstractItemModel
 {
@@ -25,10 +27,21 @@ public:
     // Set paths to display in model
     void setPaths(const QStringList &paths);
 
+    // Mark file from verification, missing items are added
+    void addProblem(const QString &path, const QString &problem);
+
 private:
-    void addPath(const QStringList &path);
+    void requestAttributes(File *file) const;
+    void loadPendingAttributes();
 
     File *m_rootItem;
+
+    // Attributes are read in background only for items requested by the view
+    mutable QVector<File *> m_pendingFiles;
+    QTimer *m_requestTimer;
+    QFuture<void> m_loadingAttributes;
+    bool m_attributesLoading = false;
+    int m_generation = 0;
 };
 
 #endif // FILESMODEL_H
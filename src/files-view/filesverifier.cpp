@@ -0,0 +1,245 @@
+#include "filesverifier.h"
+#include "../gzipstream.h"
+#include "../pacmansettings.h"
+
+#include <QCryptographicHash>
+#include <QtConcurrent>
+#include <QFile>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr int MAX_IO_THREADS = 4;
+constexpr int READ_CHUNK_SIZE = 64 * 1024;
+
+FilesVerifier::FilesVerifier(QObject *parent) :
+    QObject(parent)
+{
+    m_pool.setMaxThreadCount(qMin(QThread::idealThreadCount(), MAX_IO_THREADS));
+}
+
+FilesVerifier::~FilesVerifier()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+QString FilesVerifier::mtreeFile(const QString &packageName, const QString &packageVersion)
+{
+    const PacmanSettings settings;
+    return settings.databasesPath() + "/local/" + packageName + '-' + packageVersion + "/mtree";
+}
+
+void FilesVerifier::verify(const QVector<PackageFiles> &packages)
+{
+    // Tasks of the previous verification will be skipped
+    ++m_generation;
+    m_totalPackages = packages.size();
+    m_verifiedPackages = 0;
+    m_problemsCount = 0;
+    emit progressChanged(0, m_totalPackages);
+    if (packages.isEmpty()) {
+        emit finished(0);
+        return;
+    }
+
+    const PacmanSettings settings;
+    const QString rootDir = settings.rootDir();
+    const int generation = m_generation;
+    for (const PackageFiles &package : packages) {
+        QtConcurrent::run(&m_pool, [this, package, rootDir, generation] {
+            const QVector<Problem> problems = verifyPackage(package, rootDir, generation);
+            QMetaObject::invokeMethod(this, [this, problems, generation] {
+                processPackageProblems(problems, generation);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void FilesVerifier::cancel()
+{
+    ++m_generation;
+    m_totalPackages = 0;
+    m_verifiedPackages = 0;
+}
+
+bool FilesVerifier::isRunning() const
+{
+    return m_verifiedPackages < m_totalPackages;
+}
+
+QVector<FilesVerifier::Problem> FilesVerifier::verifyPackage(const PackageFiles &package, const QString &rootDir, int generation) const
+{
+    QVector<Problem> problems;
+    if (isCanceled(generation))
+        return problems;
+
+    QFile file(package.mtreeFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << file.errorString();
+        return problems;
+    }
+
+    // Mtree files are small, so decompress the whole file at once
+    GzipStream stream;
+    QByteArray mtree;
+    while (!file.atEnd())
+        mtree += stream.decompress(file.read(READ_CHUNK_SIZE));
+    if (stream.hasError()) {
+        problems.append({package.mtreeFile, QStringLiteral("Unable to read mtree")});
+        return problems;
+    }
+
+    const QSet<QString> backupFiles = package.backupFiles.toSet();
+
+    QHash<QByteArray, QByteArray> defaults;
+    foreach (const QByteArray &line, mtree.split('\n')) {
+        if (isCanceled(generation))
+            return problems;
+
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QList<QByteArray> words = line.simplified().split(' ');
+        if (words.first() == "/set") {
+            for (int i = 1; i < words.size(); ++i) {
+                const int separator = words.at(i).indexOf('=');
+                defaults.insert(words.at(i).left(separator), words.at(i).mid(separator + 1));
+            }
+            continue;
+        }
+        if (words.first() == "/unset") {
+            for (int i = 1; i < words.size(); ++i)
+                defaults.remove(words.at(i));
+            continue;
+        }
+
+        // Package metadata like .PKGINFO is not installed
+        const QByteArray name = unescape(words.first());
+        if (!name.startsWith("./") || name.startsWith("./."))
+            continue;
+
+        QHash<QByteArray, QByteArray> keywords = defaults;
+        for (int i = 1; i < words.size(); ++i) {
+            const int separator = words.at(i).indexOf('=');
+            keywords.insert(words.at(i).left(separator), words.at(i).mid(separator + 1));
+        }
+
+        const QString relativePath = QString::fromLocal8Bit(name.mid(2));
+        QString path = rootDir + relativePath;
+        path.replace("//", "/");
+        problems.append(verifyFile(path, keywords, backupFiles.contains(relativePath), generation));
+    }
+
+    return problems;
+}
+
+QVector<FilesVerifier::Problem> FilesVerifier::verifyFile(const QString &path, const QHash<QByteArray, QByteArray> &keywords, bool backup, int generation) const
+{
+    QVector<Problem> problems;
+    const QByteArray localPath = QFile::encodeName(path);
+    struct stat status{};
+    if (lstat(localPath.constData(), &status) != 0) {
+        problems.append({path, QStringLiteral("Missing")});
+        return problems;
+    }
+
+    // Check type first, other attributes make no sense if it differs
+    const QByteArray type = keywords.value("type", "file");
+    if ((type == "file" && !S_ISREG(status.st_mode))
+            || (type == "dir" && !S_ISDIR(status.st_mode))
+            || (type == "link" && !S_ISLNK(status.st_mode))) {
+        problems.append({path, QStringLiteral("Type changed")});
+        return problems;
+    }
+
+    if (type == "link") {
+        QByteArray target(PATH_MAX, Qt::Uninitialized);
+        const ssize_t length = readlink(localPath.constData(), target.data(), static_cast<size_t>(target.size()));
+        if (length == -1 || target.left(static_cast<int>(length)) != unescape(keywords.value("link")))
+            problems.append({path, QStringLiteral("Link target changed")});
+        return problems;
+    }
+
+    if (keywords.contains("mode") && (status.st_mode & 07777) != keywords.value("mode").toUInt(nullptr, 8))
+        problems.append({path, QStringLiteral("Permissions changed")});
+
+    // Backup files are edited by user, so pacman does not check their content
+    if (type == "dir" || backup)
+        return problems;
+
+    // Time is stored with nanoseconds, but only seconds are compared, like pacman does
+    if (keywords.contains("time") && status.st_mtim.tv_sec != keywords.value("time").split('.').first().toLongLong())
+        problems.append({path, QStringLiteral("Modification time changed")});
+
+    if (keywords.contains("size") && status.st_size != keywords.value("size").toLongLong()) {
+        problems.append({path, QStringLiteral("Size changed")});
+        return problems;
+    }
+
+    // Read content only if metadata matches
+    if (keywords.contains("sha256digest")) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            problems.append({path, QStringLiteral("No access")});
+            return problems;
+        }
+
+        // Large files are read by chunks to stop reading after cancelling
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        while (!file.atEnd()) {
+            if (isCanceled(generation))
+                return problems;
+            hash.addData(file.read(READ_CHUNK_SIZE));
+        }
+        if (hash.result().toHex() != keywords.value("sha256digest"))
+            problems.append({path, QStringLiteral("Content changed")});
+    }
+
+    return problems;
+}
+
+bool FilesVerifier::isCanceled(int generation) const
+{
+    return generation != m_generation;
+}
+
+// Mtree escapes special symbols in names as octal codes, for example "\040" for space
+QByteArray FilesVerifier::unescape(const QByteArray &name)
+{
+    if (!name.contains('\\'))
+        return name;
+
+    QByteArray result;
+    result.reserve(name.size());
+    for (int i = 0; i < name.size(); ++i) {
+        if (name.at(i) == '\\' && i + 3 < name.size()) {
+            bool ok;
+            const int code = name.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                result.append(static_cast<char>(code));
+                i += 3;
+                continue;
+            }
+        }
+        result.append(name.at(i));
+    }
+
+    return result;
+}
+
+void FilesVerifier::processPackageProblems(const QVector<Problem> &problems, int generation)
+{
+    if (generation != m_generation)
+        return;
+
+    for (const Problem &problem : problems)
+        emit problemFound(problem.first, problem.second);
+
+    m_problemsCount += problems.size();
+    ++m_verifiedPackages;
+    emit progressChanged(m_verifiedPackages, m_totalPackages);
+    if (m_verifiedPackages == m_totalPackages)
+        emit finished(m_problemsCount);
+}
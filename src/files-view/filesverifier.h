@@ -0,0 +1,58 @@
+#ifndef FILESVERIFIER_H
+#define FILESVERIFIER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+
+#include <atomic>
+
+// Compares installed files with mtree data from the local database, like pacman -Qkk
+class FilesVerifier : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(FilesVerifier)
+
+public:
+    using Problem = QPair<QString, QString>; // File path and description
+
+    struct PackageFiles {
+        QString mtreeFile;
+        QStringList backupFiles; // Relative to root, only type and permissions are checked for them
+    };
+
+    explicit FilesVerifier(QObject *parent = nullptr);
+    ~FilesVerifier() override;
+
+    static QString mtreeFile(const QString &packageName, const QString &packageVersion);
+
+    void verify(const QVector<PackageFiles> &packages);
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    void problemFound(const QString &path, const QString &problem);
+    void progressChanged(int verifiedPackages, int totalPackages);
+    void finished(int problemsCount);
+
+private:
+    // Called from pool threads
+    QVector<Problem> verifyPackage(const PackageFiles &package, const QString &rootDir, int generation) const;
+    QVector<Problem> verifyFile(const QString &path, const QHash<QByteArray, QByteArray> &keywords, bool backup, int generation) const;
+    bool isCanceled(int generation) const;
+
+    static QByteArray unescape(const QByteArray &name);
+    void processPackageProblems(const QVector<Problem> &problems, int generation);
+
+    // Limited to avoid overloading disks with parallel reads
+    QThreadPool m_pool;
+    std::atomic_int m_generation{0};
+    int m_totalPackages = 0;
+    int m_verifiedPackages = 0;
+    int m_problemsCount = 0;
+};
+
+#endif // FILESVERIFIER_H
@@ -0,0 +1,58 @@
+#include "gzipstream.h"
+
+constexpr int OUTPUT_CHUNK_SIZE = 64 * 1024;
+
+GzipStream::GzipStream()
+{
+    // Additional 16 to window bits enables gzip header decoding
+    m_error = inflateInit2(&m_stream, 16 + MAX_WBITS) != Z_OK;
+}
+
+GzipStream::~GzipStream()
+{
+    inflateEnd(&m_stream);
+}
+
+QByteArray GzipStream::decompress(const QByteArray &data)
+{
+    QByteArray output;
+    if (m_error || m_end)
+        return output;
+
+    m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    m_stream.avail_in = static_cast<uInt>(data.size());
+
+    // Inflate while there is input or output buffer was filled completely
+    do {
+        const int offset = output.size();
+        output.resize(offset + OUTPUT_CHUNK_SIZE);
+        m_stream.next_out = reinterpret_cast<Bytef *>(output.data() + offset);
+        m_stream.avail_out = OUTPUT_CHUNK_SIZE;
+
+        const int result = inflate(&m_stream, Z_NO_FLUSH);
+        output.resize(output.size() - static_cast<int>(m_stream.avail_out));
+
+        if (result == Z_STREAM_END) {
+            m_end = true;
+            break;
+        }
+        if (result == Z_BUF_ERROR) // More input is needed
+            break;
+        if (result != Z_OK) {
+            m_error = true;
+            break;
+        }
+    } while (m_stream.avail_in > 0 || m_stream.avail_out == 0);
+
+    return output;
+}
+
+bool GzipStream::hasError() const
+{
+    return m_error;
+}
+
+bool GzipStream::atEnd() const
+{
+    return m_end;
+}
@@ -0,0 +1,28 @@
+#ifndef GZIPSTREAM_H
+#define GZIPSTREAM_H
+
+#include <QByteArray>
+
+#include <zlib.h>
+
+// Decompresses gzip data by pieces to process large files without loading them into memory
+class GzipStream
+{
+    Q_DISABLE_COPY(GzipStream)
+
+public:
+    GzipStream();
+    ~GzipStream();
+
+    // Decompressed data of the next piece of compressed data
+    QByteArray decompress(const QByteArray &data);
+    bool hasError() const;
+    bool atEnd() const;
+
+private:
+    z_stream m_stream{};
+    bool m_error = false;
+    bool m_end = false;
+};
+
+#endif // GZIPSTREAM_H
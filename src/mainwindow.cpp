@@ -9,6 +9,7 @@
 #include "packages-view/package.h"
 #include "packages-view/packagesmodel.h"
 #include "files-view/filesmodel.h"
+#include "files-view/filesverifier.h"
 #include "singleapplication.h"
 
 #include <QPushButton>
@@ -20,6 +21,9 @@
 #include <QButtonGroup>
 #include <QTimer>
 #include <QShortcut>
+#include <QLocale>
+
+constexpr int MAX_REVERSE_DEPENDS = 50;
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -34,7 +38,9 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->packagesView->model(), &PackagesModel::databaseLoadingMessageChanged, this, &MainWindow::setStatusBarMessage);
     connect(ui->packagesView->model(), &PackagesModel::firstPackageAvailable, this, &MainWindow::processFirstPackageAvailable);
     connect(ui->packagesView->model(), &PackagesModel::databaseStatusChanged, this, &MainWindow::processDatabaseStatusChanged);
+    connect(ui->packagesView->model(), &PackagesModel::searchFinished, ui->searchPackagesEdit, &SearchEdit::setSearchDuration);
     connect(ui->packagesView, &PackagesView::operationsCountChanged, this, &MainWindow::processOperationsCountChanged);
+    connect(ui->packagesView->model(), &PackagesModel::removalImpactCalculated, this, &MainWindow::processRemovalImpactCalculated);
 
     // Shortcuts
     m_changeModeShortcut = new QShortcut(this);
@@ -52,6 +58,12 @@ MainWindow::MainWindow(QWidget *parent) :
     m_autosyncTimer = new AutosyncTimer(this);
     connect(m_autosyncTimer, &AutosyncTimer::timeout, m_pacman, &Pacman::syncDatabase); // Automatically sync databases in background
 
+    // Verification results are displayed in the files view
+    m_filesVerifier = new FilesVerifier(this);
+    connect(m_filesVerifier, &FilesVerifier::problemFound, ui->filesView->model(), &FilesModel::addProblem);
+    connect(m_filesVerifier, &FilesVerifier::progressChanged, this, &MainWindow::processVerificationProgress);
+    connect(m_filesVerifier, &FilesVerifier::finished, this, &MainWindow::processVerificationFinish);
+
     // Select package when clicking on dependencies
     m_depsButtonGroup = new QButtonGroup(this);
     connect(m_depsButtonGroup, qOverload<QAbstractButton *>(&QButtonGroup::buttonClicked), this, &MainWindow::findDepend);
@@ -167,6 +179,34 @@ void MainWindow::openHistoryFileFolder()
     QDesktopServices::openUrl(logFile.dir().path());
 }
 
+void MainWindow::verifyPackageFiles()
+{
+    const Package *package = ui->packagesView->currentPackage();
+    if (package == nullptr || !package->isInstalled())
+        return;
+
+    // Show files of the package to mark problems in them, the tree could contain problems of all packages
+    loadPackageFiles(package);
+    ui->packageTabsWidget->setCurrentIndex(2);
+
+    m_filesVerifier->verify({{FilesVerifier::mtreeFile(package->name(), package->version()), package->backupFiles()}});
+}
+
+void MainWindow::verifyAllFiles()
+{
+    QVector<FilesVerifier::PackageFiles> packages;
+    foreach (const Package *package, ui->packagesView->model()->installedPackages())
+        packages.append({FilesVerifier::mtreeFile(package->name(), package->version()), package->backupFiles()});
+
+    // Only files with problems will be displayed
+    ui->filesView->model()->setPaths({});
+    m_packageFilesLoaded = true;
+    ui->packageTabsWidget->setTabEnabled(2, true);
+    ui->packageTabsWidget->setCurrentIndex(2);
+
+    m_filesVerifier->verify(packages);
+}
+
 void MainWindow::openSettings()
 {
     SettingsDialog dialog;
@@ -249,13 +289,18 @@ void MainWindow::openInBrowser()
 
 void MainWindow::setSearchMode(int mode)
 {
-    // Disable search by description for AUR
+    // Disable search by description, files and orphans for AUR
+    auto *searchByModel = qobject_cast<QStandardItemModel *>(ui->searchByComboBox->model());
     if (mode == PackagesModel::AUR) {
-        qobject_cast<QStandardItemModel *>(ui->searchByComboBox->model())->item(3)->setEnabled(false);
-        if (ui->searchByComboBox->currentIndex() == 3)
+        searchByModel->item(PackagesView::Description)->setEnabled(false);
+        searchByModel->item(PackagesView::Files)->setEnabled(false);
+        searchByModel->item(PackagesView::Orphans)->setEnabled(false);
+        if (ui->searchByComboBox->currentIndex() >= PackagesView::Description)
             ui->searchByComboBox->setCurrentIndex(0);
     } else {
-        qobject_cast<QStandardItemModel *>(ui->searchByComboBox->model())->item(3)->setEnabled(true);
+        searchByModel->item(PackagesView::Description)->setEnabled(true);
+        searchByModel->item(PackagesView::Files)->setEnabled(true);
+        searchByModel->item(PackagesView::Orphans)->setEnabled(true);
     }
 
     ui->packagesView->model()->setMode(static_cast<PackagesModel::Mode>(mode));
@@ -374,6 +419,9 @@ void MainWindow::findDepend(QAbstractButton *button)
     else if (!ui->instantSearchAction->isChecked())
         searchPackages(ui->searchPackagesEdit->text());
 
+    // Filtered out packages have no rows, and the cleared text is applied only after the search delay
+    ui->packagesView->model()->setFilter(QStringList(), PackagesIndex::Fields());
+
     // Search package in repo first
     const bool found = ui->packagesView->find(button->toolTip());
     if (!found) {
@@ -429,6 +477,27 @@ void MainWindow::processOperationsCountChanged(int tasksCount)
     ui->syncButton->setChecked(ui->packagesView->isSyncRepositories());
 }
 
+void MainWindow::processRemovalImpactCalculated(qint64 targetsSize, qint64 unusedSize, const QStringList &unusedPackages)
+{
+    // Other messages, like loading progress, are kept when tasks change
+    if (targetsSize == 0 && unusedPackages.isEmpty()) {
+        if (!m_removalImpactMessage.isEmpty() && statusBar()->currentMessage() == m_removalImpactMessage)
+            statusBar()->clearMessage();
+        m_removalImpactMessage.clear();
+        return;
+    }
+
+    const QLocale locale;
+    const QString formattedTargetsSize = locale.formattedDataSize(targetsSize, 2, QLocale::DataSizeTraditionalFormat);
+    if (unusedPackages.isEmpty()) {
+        m_removalImpactMessage = tr("Uninstalling will free %1").arg(formattedTargetsSize);
+    } else {
+        m_removalImpactMessage = tr("Uninstalling will free %1 and %2 from unused dependencies: %3")
+                .arg(formattedTargetsSize, locale.formattedDataSize(unusedSize, 2, QLocale::DataSizeTraditionalFormat), unusedPackages.join(", "));
+    }
+    statusBar()->showMessage(m_removalImpactMessage);
+}
+
 void MainWindow::processTerminalStart()
 {
     processDatabaseStatusChanged(PackagesModel::Loading);
@@ -442,10 +511,25 @@ void MainWindow::processTerminalFinish(int exitCode)
         else
             processDatabaseStatusChanged(PackagesModel::UpdatesAvailable);
     } else {
-        reloadDatabase();
+        // Performed operations are no longer relevant, update only changed packages
+        ui->packagesView->clearAllOperations();
+        ui->packagesView->model()->reloadRepoPackages(PackagesModel::DeltaReload);
     }
 }
 
+void MainWindow::processVerificationProgress(int verifiedPackages, int totalPackages)
+{
+    statusBar()->showMessage(tr("Verifying files: %1 of %2 packages").arg(verifiedPackages).arg(totalPackages));
+}
+
+void MainWindow::processVerificationFinish(int problemsCount)
+{
+    if (problemsCount == 0)
+        statusBar()->showMessage(tr("Verification finished: no problems found"));
+    else
+        statusBar()->showMessage(tr("Verification finished: %1 problems found").arg(problemsCount));
+}
+
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     // Check if user disabled minimizing to tray
@@ -544,11 +628,22 @@ void MainWindow::loadPackageDeps(const Package *package)
     loadDepsButtons(3, package->depends());
     loadDepsButtons(4, package->optdepends());
 
+    // Reverse dependencies are taken from the graph of all packages, so common libraries have thousands of them
+    QVector<Depend> requiredBy;
+    foreach (const QString &packageName, ui->packagesView->model()->requiredBy(package->name()))
+        requiredBy.append(Depend(packageName));
+    QVector<Depend> optionalFor;
+    foreach (const QString &packageName, ui->packagesView->model()->optionalFor(package->name()))
+        optionalFor.append(Depend(packageName));
+    loadDepsButtons(5, requiredBy, MAX_REVERSE_DEPENDS);
+    loadDepsButtons(6, optionalFor, MAX_REVERSE_DEPENDS);
+
     m_packageDepsLoaded = true;
 }
 
 void MainWindow::loadPackageFiles(const Package *package)
 {
+    m_filesVerifier->cancel();
     ui->filesView->model()->setPaths(package->files());
     m_packageFilesLoaded = true;
 }
@@ -573,7 +668,7 @@ void MainWindow::displayInfo(bool display, const QString &text, QLabel *titleLab
     }
 }
 
-void MainWindow::loadDepsButtons(int row, const QVector<Depend> &deps)
+void MainWindow::loadDepsButtons(int row, const QVector<Depend> &deps, int limit)
 {
     auto *depsContentLayout = qobject_cast<QFormLayout *>(ui->depsContentWidget->layout());
     auto *packagesLabel = qobject_cast<QLabel *>(depsContentLayout->itemAt(row, QFormLayout::LabelRole)->widget());
@@ -592,7 +687,9 @@ void MainWindow::loadDepsButtons(int row, const QVector<Depend> &deps)
     }
 
     // Add new
-    foreach (const Depend &depend, deps) {
+    const int count = limit == -1 ? deps.size() : qMin(limit, deps.size());
+    for (int i = 0; i < count; ++i) {
+        const Depend &depend = deps.at(i);
         auto *button = new QPushButton;
         button->setFlat(true);
         button->setStyleSheet("padding: 6px");
@@ -605,6 +702,16 @@ void MainWindow::loadDepsButtons(int row, const QVector<Depend> &deps)
         m_depsButtonGroup->addButton(button);
         packagesLayout->addWidget(button);
     }
+
+    // Link removes itself while reloading, so reload after its signal
+    if (count < deps.size()) {
+        auto *showAllLabel = new QLabel("<a href=\"#\">" + tr("Show all %1 packages").arg(deps.size()) + "</a>");
+        showAllLabel->setMargin(6);
+        connect(showAllLabel, &QLabel::linkActivated, this, [this, row, deps] {
+            loadDepsButtons(row, deps);
+        }, Qt::QueuedConnection);
+        packagesLayout->addWidget(showAllLabel);
+    }
     packagesLabel->show();
 }
 
@@ -630,6 +737,7 @@ void MainWindow::loadAppSettings()
         }
     }
     QNetworkProxy::setApplicationProxy(proxy);
+    ui->packagesView->model()->setOfflineAurSearch(settings.isOfflineAurSearchEnabled(), settings.aurArchiveFile());
 
     // Shortcuts
     m_changeModeShortcut->setKey(QKeySequence(settings.changeModeShortcut()));
@@ -15,6 +15,7 @@ class Package;
 class AutosyncTimer;
 class SystemTray;
 class QShortcut;
+class FilesVerifier;
 
 namespace Ui {
 class MainWindow;
@@ -41,6 +42,8 @@ private slots:
     void openHistoryFileFolder();
     void openSettings();
     void setAfterTasksCompletionAction(QAction *action);
+    void verifyPackageFiles();
+    void verifyAllFiles();
 
     // Tray context menu
     void syncAndUpgrade();
@@ -67,8 +70,11 @@ private slots:
     void processDatabaseStatusChanged(PackagesModel::DatabaseStatus status);
     void processFirstPackageAvailable();
     void processOperationsCountChanged(int tasksCount);
+    void processRemovalImpactCalculated(qint64 targetsSize, qint64 unusedSize, const QStringList &unusedPackages);
     void processTerminalStart();
     void processTerminalFinish(int exitCode);
+    void processVerificationProgress(int verifiedPackages, int totalPackages);
+    void processVerificationFinish(int problemsCount);
 
 private:
     void closeEvent(QCloseEvent *event) override;
@@ -80,7 +86,7 @@ private:
 
     // Helper functions
     void displayInfo(bool display, const QString &text, QLabel *titleLabel, QLabel *label);
-    void loadDepsButtons(int row, const QVector<Depend> &deps);
+    void loadDepsButtons(int row, const QVector<Depend> &deps, int limit = -1);
 
     void loadAppSettings();
     void loadMainWindowSettings();
@@ -96,6 +102,8 @@ private:
     Pacman *m_pacman;
     AutosyncTimer *m_autosyncTimer;
     SystemTray *m_trayIcon;
+    FilesVerifier *m_filesVerifier;
+    QString m_removalImpactMessage;
 
     bool m_packageInfoLoaded = false;
     bool m_packageDepsLoaded = false;
@@ -0,0 +1,118 @@
+#include "aurarchive.h"
+#include "../gzipstream.h"
+
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QDebug>
+
+constexpr int READ_CHUNK_SIZE = 256 * 1024;
+constexpr int MAX_SEARCH_RESULTS = 5000; // The same limit as AUR RPC has
+constexpr const char *LIST_FIELDS[] = {"Name", "PackageBase", "Version", "Description", "URL", "NumVotes",
+                                       "Popularity", "OutOfDate", "Maintainer", "FirstSubmitted", "LastModified"};
+
+QString AurArchive::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/packages-meta-ext-v1.json.gz";
+}
+
+bool AurArchive::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << file.errorString();
+        return false;
+    }
+
+    // Split top-level array into packages while decompressing to avoid holding the whole archive in memory
+    const bool compressed = fileName.endsWith(".gz");
+    GzipStream stream;
+    QByteArray pendingPackage;
+    bool insidePackage = false;
+    bool insideString = false;
+    bool escaped = false;
+    int depth = 0;
+    while (!file.atEnd()) {
+        const QByteArray data = compressed ? stream.decompress(file.read(READ_CHUNK_SIZE)) : file.read(READ_CHUNK_SIZE);
+        if (stream.hasError()) {
+            qDebug() << "AUR archive is corrupted";
+            return false;
+        }
+
+        int packageStart = insidePackage ? 0 : -1;
+        for (int i = 0; i < data.size(); ++i) {
+            const char symbol = data.at(i);
+            if (insideString) {
+                if (escaped)
+                    escaped = false;
+                else if (symbol == '\\')
+                    escaped = true;
+                else if (symbol == '"')
+                    insideString = false;
+                continue;
+            }
+
+            switch (symbol) {
+            case '"':
+                insideString = true;
+                break;
+            case '{':
+            case '[':
+                if (++depth == 2) {
+                    packageStart = i;
+                    insidePackage = true;
+                }
+                break;
+            case '}':
+            case ']':
+                if (--depth == 1 && insidePackage) {
+                    addPackage(pendingPackage + data.mid(packageStart, i - packageStart + 1));
+                    pendingPackage.clear();
+                    packageStart = -1;
+                    insidePackage = false;
+                }
+                break;
+            }
+        }
+
+        if (insidePackage)
+            pendingPackage += data.mid(packageStart);
+    }
+
+    // Truncated download ends without errors, but in the middle of the stream or the array
+    if ((compressed && !stream.atEnd()) || depth != 0) {
+        qDebug() << "AUR archive is truncated";
+        return false;
+    }
+
+    m_index.build();
+    return true;
+}
+
+QJsonArray AurArchive::search(const QStringList &terms, PackagesIndex::Fields fields) const
+{
+    QJsonArray results;
+    const QVector<int> ids = m_index.find(terms, fields);
+    for (int i = 0; i < ids.size() && i < MAX_SEARCH_RESULTS; ++i)
+        results.append(QJsonDocument::fromJson(m_packages.at(ids.at(i))).object());
+
+    return results;
+}
+
+void AurArchive::addPackage(const QByteArray &packageJson)
+{
+    const QJsonObject package = QJsonDocument::fromJson(packageJson).object();
+    if (package.isEmpty())
+        return;
+
+    QJsonObject listPackage;
+    for (const char *field : LIST_FIELDS) {
+        const QJsonValue value = package.value(field);
+        if (!value.isUndefined())
+            listPackage.insert(field, value);
+    }
+
+    m_packages.append(QJsonDocument(listPackage).toJson(QJsonDocument::Compact));
+    m_index.append(package.value("Name").toString(), package.value("Description").toString(), package.value("Maintainer").toString());
+}
@@ -0,0 +1,26 @@
+#ifndef AURARCHIVE_H
+#define AURARCHIVE_H
+
+#include "packagesindex.h"
+
+#include <QJsonArray>
+
+// Local copy of AUR metadata archive to search packages without requests
+class AurArchive
+{
+public:
+    static QString defaultFileName();
+
+    // Read gzip-compressed or plain JSON array of packages
+    bool load(const QString &fileName);
+    QJsonArray search(const QStringList &terms, PackagesIndex::Fields fields) const;
+
+private:
+    void addPackage(const QByteArray &packageJson);
+
+    // Compact JSON of fields displayed in the packages list
+    QVector<QByteArray> m_packages;
+    PackagesIndex m_index;
+};
+
+#endif // AURARCHIVE_H
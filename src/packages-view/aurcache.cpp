@@ -0,0 +1,134 @@
+#include "aurcache.h"
+
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+constexpr int CACHE_VERSION = 1;
+constexpr qint64 CACHE_TTL = 60 * 60; // In seconds
+constexpr int MAX_CACHED_QUERIES = 64;
+
+void AurCache::load()
+{
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+    if (cache.value("version").toInt() != CACHE_VERSION)
+        return;
+
+    const QJsonObject info = cache.value("info").toObject();
+    for (auto it = info.constBegin(); it != info.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        m_info.insert(it.key(), {entry.value("data").toObject(), static_cast<qint64>(entry.value("fetched").toDouble())});
+    }
+
+    const QJsonObject queries = cache.value("queries").toObject();
+    for (auto it = queries.constBegin(); it != queries.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        m_queries.insert(it.key(), {entry.value("results").toArray(),
+                                    entry.value("tag").toString().toUtf8(),
+                                    static_cast<qint64>(entry.value("fetched").toDouble())});
+    }
+}
+
+void AurCache::save() const
+{
+    QJsonObject info;
+    for (auto it = m_info.cbegin(); it != m_info.cend(); ++it)
+        info.insert(it.key(), QJsonObject{{"data", it->data}, {"fetched", it->fetched}});
+
+    QJsonObject queries;
+    for (auto it = m_queries.cbegin(); it != m_queries.cend(); ++it)
+        queries.insert(it.key(), QJsonObject{{"results", it->results}, {"tag", QString::fromUtf8(it->tag)}, {"fetched", it->fetched}});
+
+    const QJsonObject cache{{"version", CACHE_VERSION}, {"info", info}, {"queries", queries}};
+
+    QDir().mkpath(QFileInfo(fileName()).path());
+    QSaveFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << file.errorString();
+        return;
+    }
+
+    file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+bool AurCache::containsInfo(const QString &packageName) const
+{
+    return m_info.contains(packageName);
+}
+
+bool AurCache::isInfoFresh(const QString &packageName) const
+{
+    return isFresh(m_info.value(packageName).fetched);
+}
+
+QJsonObject AurCache::info(const QString &packageName) const
+{
+    return m_info.value(packageName).data;
+}
+
+void AurCache::insertInfo(const QString &packageName, const QJsonObject &packageData)
+{
+    m_info.insert(packageName, {packageData, QDateTime::currentSecsSinceEpoch()});
+}
+
+bool AurCache::containsQuery(const QString &query) const
+{
+    return m_queries.contains(query);
+}
+
+bool AurCache::isQueryFresh(const QString &query) const
+{
+    return isFresh(m_queries.value(query).fetched);
+}
+
+QJsonArray AurCache::queryResults(const QString &query) const
+{
+    return m_queries.value(query).results;
+}
+
+QByteArray AurCache::queryTag(const QString &query) const
+{
+    return m_queries.value(query).tag;
+}
+
+void AurCache::insertQuery(const QString &query, const QJsonArray &results, const QByteArray &tag)
+{
+    // Remove the oldest query to limit the cache size
+    if (!m_queries.contains(query) && m_queries.size() >= MAX_CACHED_QUERIES) {
+        auto oldest = m_queries.begin();
+        for (auto it = m_queries.begin(); it != m_queries.end(); ++it) {
+            if (it->fetched < oldest->fetched)
+                oldest = it;
+        }
+        m_queries.erase(oldest);
+    }
+
+    m_queries.insert(query, {results, tag, QDateTime::currentSecsSinceEpoch()});
+}
+
+// Query was revalidated and its results are still actual
+void AurCache::refreshQuery(const QString &query)
+{
+    auto it = m_queries.find(query);
+    if (it != m_queries.end())
+        it->fetched = QDateTime::currentSecsSinceEpoch();
+}
+
+QString AurCache::fileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/aur.json";
+}
+
+bool AurCache::isFresh(qint64 fetched)
+{
+    return QDateTime::currentSecsSinceEpoch() - fetched < CACHE_TTL;
+}
@@ -0,0 +1,47 @@
+#ifndef AURCACHE_H
+#define AURCACHE_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+
+// AUR RPC results stored on disk, entries older than TTL should be revalidated
+class AurCache
+{
+public:
+    void load();
+    void save() const;
+
+    // Package info by name, package that is absent in AUR is stored as an empty object
+    bool containsInfo(const QString &packageName) const;
+    bool isInfoFresh(const QString &packageName) const;
+    QJsonObject info(const QString &packageName) const;
+    void insertInfo(const QString &packageName, const QJsonObject &packageData);
+
+    // Search results by query
+    bool containsQuery(const QString &query) const;
+    bool isQueryFresh(const QString &query) const;
+    QJsonArray queryResults(const QString &query) const;
+    QByteArray queryTag(const QString &query) const;
+    void insertQuery(const QString &query, const QJsonArray &results, const QByteArray &tag);
+    void refreshQuery(const QString &query);
+
+private:
+    struct InfoEntry {
+        QJsonObject data;
+        qint64 fetched = 0;
+    };
+    struct QueryEntry {
+        QJsonArray results;
+        QByteArray tag;
+        qint64 fetched = 0;
+    };
+
+    static QString fileName();
+    static bool isFresh(qint64 fetched);
+
+    QHash<QString, InfoEntry> m_info;
+    QHash<QString, QueryEntry> m_queries;
+};
+
+#endif // AURCACHE_H
@@ -0,0 +1,300 @@
+#include "aurclient.h"
+#include "aurarchive.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+constexpr char AUR_API_URL[] = "https://aur.archlinux.org/rpc/";
+constexpr char AUR_ARCHIVE_URL[] = "https://aur.archlinux.org/packages-meta-ext-v1.json.gz";
+constexpr int MAX_QUERY_LENGTH = 4000; // Longer URLs are rejected by the server
+constexpr qint64 ARCHIVE_TTL = 24 * 60 * 60; // In seconds, the archive is regenerated periodically
+
+AurClient::AurClient(QObject *parent) :
+    QObject(parent)
+{
+    m_manager = new QNetworkAccessManager(this);
+    m_cache.load();
+
+    connect(&m_archiveWatcher, &QFutureWatcher<QSharedPointer<const AurArchive>>::finished, this, [this] {
+        if (m_offlineSearch)
+            m_archive = m_archiveWatcher.result();
+    });
+}
+
+AurClient::~AurClient()
+{
+    m_archiveWatcher.waitForFinished();
+    m_cache.save();
+}
+
+// Cached results are shown immediately and revalidated in background when outdated
+void AurClient::search(const QString &text, const QString &searchType)
+{
+    abort(m_searchReply);
+
+    if (m_archive != nullptr) {
+        PackagesIndex::Fields fields = PackagesIndex::Name;
+        if (searchType == "name-desc")
+            fields |= PackagesIndex::Description;
+        else if (searchType == "maintainer")
+            fields = PackagesIndex::Maintainer;
+
+        emit searchFinished(m_archive->search(text.split(' ', QString::SkipEmptyParts), fields));
+        return;
+    }
+
+    const QString query = "v=5&type=search&by=" + searchType + "&arg=" + text;
+    if (m_cache.containsQuery(query)) {
+        emit searchFinished(m_cache.queryResults(query));
+        if (m_cache.isQueryFresh(query))
+            return;
+    }
+
+    QNetworkReply *reply = get(query, m_cache.queryTag(query));
+    m_searchReply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, query] {
+        if (reply != m_searchReply || reply->error() != QNetworkReply::NoError)
+            return;
+
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+            m_cache.refreshQuery(query);
+            return;
+        }
+
+        const bool cached = m_cache.containsQuery(query);
+        const QJsonArray results = readResults(reply);
+        if (cached && m_cache.queryResults(query) == results) {
+            m_cache.refreshQuery(query);
+            return;
+        }
+
+        m_cache.insertQuery(query, results, reply->rawHeader("ETag"));
+        emit searchFinished(results);
+    });
+}
+
+void AurClient::loadDetails(const QString &packageName)
+{
+    abort(m_detailsReply);
+
+    const QJsonObject cachedData = m_cache.info(packageName);
+    if (!cachedData.isEmpty()) {
+        emit detailsLoaded(cachedData);
+        if (m_cache.isInfoFresh(packageName))
+            return;
+    }
+
+    QNetworkReply *reply = get("v=5&type=info&arg[]=" + packageName);
+    m_detailsReply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, packageName] {
+        if (reply != m_detailsReply || reply->error() != QNetworkReply::NoError)
+            return;
+
+        const QJsonArray results = readResults(reply);
+        const QJsonObject packageData = results.isEmpty() ? QJsonObject() : results.at(0).toObject();
+        const bool changed = m_cache.info(packageName) != packageData;
+        m_cache.insertInfo(packageName, packageData);
+        if (changed && !packageData.isEmpty())
+            emit detailsLoaded(packageData);
+    });
+}
+
+// Cached info is passed at once, then outdated and missing info is requested
+// by chunks of bounded length that are sent concurrently
+void AurClient::loadInfo(const QStringList &packageNames)
+{
+    abortInfo();
+
+    QJsonArray cachedResults;
+    QStringList outdatedNames;
+    foreach (const QString &packageName, packageNames) {
+        if (m_cache.containsInfo(packageName)) {
+            const QJsonObject packageData = m_cache.info(packageName);
+            if (!packageData.isEmpty())
+                cachedResults.append(packageData);
+            if (m_cache.isInfoFresh(packageName))
+                continue;
+        }
+        outdatedNames.append(packageName);
+    }
+
+    // Caller waits for the first notification even if nothing is cached
+    m_infoFromCache = !cachedResults.isEmpty() || outdatedNames.isEmpty();
+    if (m_infoFromCache)
+        emit infoLoaded(cachedResults);
+
+    QStringList queries;
+    QVector<QStringList> chunks;
+    foreach (const QString &packageName, outdatedNames) {
+        const QString argument = "&arg[]=" + QString::fromLatin1(QUrl::toPercentEncoding(packageName));
+        if (queries.isEmpty() || queries.constLast().size() + argument.size() > MAX_QUERY_LENGTH) {
+            queries.append(QStringLiteral("v=5&type=info"));
+            chunks.append(QStringList());
+        }
+        queries.last().append(argument);
+        chunks.last().append(packageName);
+    }
+
+    for (int i = 0; i < queries.size(); ++i) {
+        const QStringList chunk = chunks.at(i);
+        QNetworkReply *reply = get(queries.at(i));
+        m_infoReplies.append(reply);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, chunk] {
+            if (!m_infoReplies.removeOne(reply))
+                return;
+
+            // Results of failed requests are skipped to let the caller finish its work
+            if (reply->error() == QNetworkReply::NoError)
+                processInfoResults(chunk, readResults(reply));
+
+            if (m_infoReplies.isEmpty()) {
+                const QJsonArray results = m_infoResults;
+                m_infoResults = QJsonArray();
+                m_cache.save();
+
+                // Only changed info should be passed after cached one
+                if (!m_infoFromCache || !results.isEmpty())
+                    emit infoLoaded(results);
+            }
+        });
+    }
+}
+
+void AurClient::abortInfo()
+{
+    // Aborted replies should not be counted as finished
+    const QVector<QNetworkReply *> replies = m_infoReplies;
+    m_infoReplies.clear();
+    m_infoResults = QJsonArray();
+    for (QNetworkReply *reply : replies)
+        reply->abort();
+}
+
+void AurClient::processInfoResults(const QStringList &packageNames, const QJsonArray &results)
+{
+    QHash<QString, QJsonObject> loadedData;
+    foreach (const QJsonValue &packageData, results)
+        loadedData.insert(packageData["Name"].toString(), packageData.toObject());
+
+    // Packages without results are cached too to avoid requesting them again
+    foreach (const QString &packageName, packageNames) {
+        const QJsonObject packageData = loadedData.value(packageName);
+        if ((!m_infoFromCache || m_cache.info(packageName) != packageData) && !packageData.isEmpty())
+            m_infoResults.append(packageData);
+        m_cache.insertInfo(packageName, packageData);
+    }
+}
+
+void AurClient::setOfflineSearch(bool enabled, const QString &archiveFile)
+{
+    const QString fileName = archiveFile.isEmpty() ? AurArchive::defaultFileName() : archiveFile;
+    if (enabled == m_offlineSearch && fileName == m_archiveFileName)
+        return;
+
+    m_offlineSearch = enabled;
+    m_archiveFileName = fileName;
+    m_archive.reset();
+    abort(m_archiveReply);
+    if (!enabled)
+        return;
+
+    // Own archive file is never replaced
+    const QFileInfo archiveInfo(fileName);
+    if (archiveFile.isEmpty() && (!archiveInfo.exists() || archiveInfo.lastModified().secsTo(QDateTime::currentDateTime()) > ARCHIVE_TTL))
+        downloadArchive(fileName);
+    else
+        loadArchive(fileName);
+}
+
+void AurClient::downloadArchive(const QString &fileName)
+{
+    QDir().mkpath(QFileInfo(fileName).path());
+
+    QNetworkReply *reply = m_manager->get(QNetworkRequest(QUrl(AUR_ARCHIVE_URL)));
+    m_archiveReply = reply;
+    auto *file = new QSaveFile(fileName, reply);
+    if (!file->open(QIODevice::WriteOnly)) {
+        qDebug() << file->errorString();
+        abort(m_archiveReply);
+        reply->deleteLater();
+        return;
+    }
+
+    // Write by pieces to avoid keeping the whole archive in memory
+    connect(reply, &QNetworkReply::readyRead, file, [reply, file] {
+        file->write(reply->readAll());
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, file, fileName] {
+        reply->deleteLater();
+        if (reply != m_archiveReply)
+            return;
+
+        // Use outdated archive if it can't be updated
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << reply->errorString();
+            file->cancelWriting();
+        } else {
+            file->write(reply->readAll());
+            file->commit();
+        }
+
+        if (QFileInfo::exists(fileName))
+            loadArchive(fileName);
+    });
+}
+
+void AurClient::loadArchive(const QString &fileName)
+{
+    m_archiveWatcher.setFuture(QtConcurrent::run([fileName] {
+        QSharedPointer<AurArchive> archive(new AurArchive);
+        if (!archive->load(fileName))
+            archive.reset();
+        return QSharedPointer<const AurArchive>(archive);
+    }));
+}
+
+QNetworkReply *AurClient::get(const QString &query, const QByteArray &tag)
+{
+    QUrl url(AUR_API_URL);
+    url.setQuery(query);
+
+    // Concurrent requests can share one connection
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    if (!tag.isEmpty())
+        request.setRawHeader("If-None-Match", tag);
+    QNetworkReply *reply = m_manager->get(request);
+
+    connect(reply, &QNetworkReply::finished, reply, [reply] {
+        if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError)
+            qDebug() << reply->errorString();
+        reply->deleteLater();
+    });
+
+    return reply;
+}
+
+// Reply is detached before aborting because it emits finished immediately
+void AurClient::abort(QPointer<QNetworkReply> &reply)
+{
+    if (reply == nullptr)
+        return;
+
+    QNetworkReply *abortedReply = reply;
+    reply = nullptr;
+    abortedReply->abort();
+}
+
+QJsonArray AurClient::readResults(QNetworkReply *reply)
+{
+    const QJsonObject jsonData = QJsonDocument::fromJson(reply->readAll()).object();
+    return jsonData.value("results").toArray();
+}
@@ -0,0 +1,69 @@
+#ifndef AURCLIENT_H
+#define AURCLIENT_H
+
+#include "aurcache.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QJsonArray>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+
+class AurArchive;
+
+class QJsonObject;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Asynchronous AUR RPC client, a new request of the same kind aborts the previous one
+class AurClient : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AurClient)
+
+public:
+    explicit AurClient(QObject *parent = nullptr);
+    ~AurClient() override;
+
+    void search(const QString &text, const QString &searchType);
+    void loadDetails(const QString &packageName);
+    void loadInfo(const QStringList &packageNames);
+    void abortInfo();
+
+    // Search in local copy of AUR metadata archive, it is downloaded if file is not specified
+    void setOfflineSearch(bool enabled, const QString &archiveFile = QString());
+
+signals:
+    void searchFinished(const QJsonArray &results);
+    void detailsLoaded(const QJsonObject &packageData);
+    void infoLoaded(const QJsonArray &results);
+
+private:
+    void processInfoResults(const QStringList &packageNames, const QJsonArray &results);
+    QNetworkReply *get(const QString &query, const QByteArray &tag = QByteArray());
+    void downloadArchive(const QString &fileName);
+    void loadArchive(const QString &fileName);
+    static void abort(QPointer<QNetworkReply> &reply);
+    static QJsonArray readResults(QNetworkReply *reply);
+
+    QNetworkAccessManager *m_manager;
+    QPointer<QNetworkReply> m_searchReply;
+    QPointer<QNetworkReply> m_detailsReply;
+
+    // Info is requested by several concurrent requests
+    QVector<QNetworkReply *> m_infoReplies;
+    QJsonArray m_infoResults;
+    bool m_infoFromCache = false;
+
+    AurCache m_cache;
+
+    // Offline search
+    bool m_offlineSearch = false;
+    QString m_archiveFileName;
+    QSharedPointer<const AurArchive> m_archive;
+    QFutureWatcher<QSharedPointer<const AurArchive>> m_archiveWatcher;
+    QPointer<QNetworkReply> m_archiveReply;
+};
+
+#endif // AURCLIENT_H
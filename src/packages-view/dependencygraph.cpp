@@ -0,0 +1,249 @@
+#include "dependencygraph.h"
+#include "package.h"
+
+#include <algorithm>
+
+void DependencyGraph::build(const QVector<Package *> &packages)
+{
+    // The first package with a name is used, like in pacman
+    QVector<const Package *> nodes;
+    nodes.reserve(packages.size());
+    m_ids.reserve(packages.size());
+    for (const Package *package : packages) {
+        const QString name = package->name();
+        if (m_ids.contains(name))
+            continue;
+
+        m_ids.insert(name, m_names.size());
+        m_names.append(name);
+        m_installed.append(package->isInstalled());
+        m_explicit.append(package->isInstalledExplicitly());
+        m_installedSizes.append(qMax<qint64>(package->installedSize(), 0));
+        nodes.append(package);
+    }
+
+    QVector<QVector<QString>> dependsNames(nodes.size());
+    QVector<QVector<QString>> optdependsNames(nodes.size());
+    for (int id = 0; id < nodes.size(); ++id) {
+        foreach (const Depend &provide, nodes.at(id)->provides()) {
+            QVector<int> &providers = m_providers[provide.name()];
+            if (!providers.contains(id))
+                providers.append(id);
+        }
+        foreach (const Depend &depend, nodes.at(id)->depends())
+            dependsNames[id].append(depend.name());
+        foreach (const Depend &depend, nodes.at(id)->optdepends())
+            optdependsNames[id].append(depend.name());
+    }
+
+    m_depends = collectEdges(dependsNames);
+    m_optdepends = collectEdges(optdependsNames);
+    m_requiredBy = m_depends.transposed(m_names.size());
+    m_optionalFor = m_optdepends.transposed(m_names.size());
+}
+
+int DependencyGraph::id(const QString &packageName) const
+{
+    return m_ids.value(packageName, -1);
+}
+
+QString DependencyGraph::name(int id) const
+{
+    return m_names.at(id);
+}
+
+int DependencyGraph::size() const
+{
+    return m_names.size();
+}
+
+QVector<int> DependencyGraph::depends(int id) const
+{
+    return m_depends.adjacent(id);
+}
+
+QVector<int> DependencyGraph::optdepends(int id) const
+{
+    return m_optdepends.adjacent(id);
+}
+
+QVector<int> DependencyGraph::requiredBy(int id) const
+{
+    return m_requiredBy.adjacent(id);
+}
+
+QVector<int> DependencyGraph::optionalFor(int id) const
+{
+    return m_optionalFor.adjacent(id);
+}
+
+QStringList DependencyGraph::names(const QVector<int> &ids) const
+{
+    QStringList names;
+    names.reserve(ids.size());
+    for (int id : ids)
+        names.append(m_names.at(id));
+
+    return names;
+}
+
+// Everything reachable from explicitly installed packages is needed
+QVector<int> DependencyGraph::unneeded(bool optdependsRequired) const
+{
+    QVector<bool> needed(m_names.size(), false);
+    QVector<int> queue;
+    for (int id = 0; id < m_names.size(); ++id) {
+        if (m_installed.at(id) && m_explicit.at(id)) {
+            needed[id] = true;
+            queue.append(id);
+        }
+    }
+
+    // Only installed providers can satisfy dependencies of installed packages
+    const auto visit = [this, &needed, &queue](const Edges &edges, int id) {
+        for (int edge = edges.offsets.at(id); edge < edges.offsets.at(id + 1); ++edge) {
+            const int dependId = edges.targets.at(edge);
+            if (m_installed.at(dependId) && !needed.at(dependId)) {
+                needed[dependId] = true;
+                queue.append(dependId);
+            }
+        }
+    };
+    for (int i = 0; i < queue.size(); ++i) {
+        visit(m_depends, queue.at(i));
+        if (optdependsRequired)
+            visit(m_optdepends, queue.at(i));
+    }
+
+    QVector<int> unneeded;
+    for (int id = 0; id < m_names.size(); ++id) {
+        if (m_installed.at(id) && !needed.at(id))
+            unneeded.append(id);
+    }
+
+    return unneeded;
+}
+
+QVector<int> DependencyGraph::unusedDependencies(const QVector<int> &removed, const QVector<int> &recursive) const
+{
+    QVector<bool> removing(m_names.size(), false);
+    for (int id : removed + recursive) {
+        if (id != -1)
+            removing[id] = true;
+    }
+
+    // Removal of each package could make its dependencies unused, explicitly installed packages are kept
+    QVector<int> queue;
+    for (int id : recursive) {
+        if (id != -1)
+            queue.append(id);
+    }
+    QVector<int> unused;
+    for (int i = 0; i < queue.size(); ++i) {
+        const int id = queue.at(i);
+        for (int edge = m_depends.offsets.at(id); edge < m_depends.offsets.at(id + 1); ++edge) {
+            const int dependId = m_depends.targets.at(edge);
+            if (removing.at(dependId) || !m_installed.at(dependId) || m_explicit.at(dependId))
+                continue;
+
+            // Dependency rejected here is checked again when its last remaining requirer is removed
+            bool required = false;
+            for (int reverseEdge = m_requiredBy.offsets.at(dependId); reverseEdge < m_requiredBy.offsets.at(dependId + 1); ++reverseEdge) {
+                const int requirerId = m_requiredBy.targets.at(reverseEdge);
+                if (m_installed.at(requirerId) && !removing.at(requirerId)) {
+                    required = true;
+                    break;
+                }
+            }
+            if (required)
+                continue;
+
+            removing[dependId] = true;
+            queue.append(dependId);
+            unused.append(dependId);
+        }
+    }
+
+    return unused;
+}
+
+qint64 DependencyGraph::installedSize(const QVector<int> &ids) const
+{
+    qint64 size = 0;
+    for (int id : ids) {
+        if (id != -1)
+            size += m_installedSizes.at(id);
+    }
+
+    return size;
+}
+
+// Installed packages are satisfied only by installed ones, like pacman does, others by names first and then by provides
+QVector<int> DependencyGraph::resolve(const QString &dependName, bool installed) const
+{
+    const int dependId = m_ids.value(dependName, -1);
+    if (installed) {
+        if (dependId != -1 && m_installed.at(dependId))
+            return {dependId};
+
+        QVector<int> providers;
+        for (int providerId : m_providers.value(dependName)) {
+            if (m_installed.at(providerId))
+                providers.append(providerId);
+        }
+        return providers;
+    }
+
+    if (dependId != -1)
+        return {dependId};
+
+    return m_providers.value(dependName);
+}
+
+DependencyGraph::Edges DependencyGraph::collectEdges(const QVector<QVector<QString>> &dependNames) const
+{
+    Edges edges;
+    edges.offsets.reserve(dependNames.size() + 1);
+    for (int id = 0; id < dependNames.size(); ++id) {
+        edges.offsets.append(edges.targets.size());
+        const int first = edges.targets.size();
+        for (const QString &dependName : dependNames.at(id)) {
+            for (int dependId : resolve(dependName, m_installed.at(id))) {
+                // Package can depend on several names of the same provider
+                if (dependId != id && std::find(edges.targets.cbegin() + first, edges.targets.cend(), dependId) == edges.targets.cend())
+                    edges.targets.append(dependId);
+            }
+        }
+    }
+    edges.offsets.append(edges.targets.size());
+
+    return edges;
+}
+
+QVector<int> DependencyGraph::Edges::adjacent(int id) const
+{
+    if (id < 0 || id + 1 >= offsets.size())
+        return {};
+
+    return targets.mid(offsets.at(id), offsets.at(id + 1) - offsets.at(id));
+}
+
+// Reverse edges are counted first to place them without additional allocations
+DependencyGraph::Edges DependencyGraph::Edges::transposed(int size) const
+{
+    Edges reversed;
+    reversed.offsets.fill(0, size + 1);
+    for (int target : targets)
+        ++reversed.offsets[target + 1];
+    for (int id = 0; id < size; ++id)
+        reversed.offsets[id + 1] += reversed.offsets.at(id);
+
+    reversed.targets.resize(targets.size());
+    QVector<int> positions = reversed.offsets;
+    for (int id = 0; id < size; ++id) {
+        for (int edge = offsets.at(id); edge < offsets.at(id + 1); ++edge)
+            reversed.targets[positions[targets.at(edge)]++] = id;
+    }
+
+    return reversed;
+}
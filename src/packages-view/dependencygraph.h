@@ -0,0 +1,63 @@
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+class Package;
+
+// Dependencies between packages stored as compressed adjacency arrays over package ids.
+// Packages are identified by names because loaded packages can be merged into existing objects.
+class DependencyGraph
+{
+public:
+    // Installed packages depend only on installed ones, others are resolved by names first and by provides if there is no such package
+    void build(const QVector<Package *> &packages);
+
+    int id(const QString &packageName) const;
+    QString name(int id) const;
+    int size() const;
+
+    // Adjacent packages ids
+    QVector<int> depends(int id) const;
+    QVector<int> optdepends(int id) const;
+    QVector<int> requiredBy(int id) const;
+    QVector<int> optionalFor(int id) const;
+
+    QStringList names(const QVector<int> &ids) const;
+
+    // Installed dependencies that no explicitly installed package needs, including dependency cycles
+    QVector<int> unneeded(bool optdependsRequired) const;
+
+    // Dependencies that pacman -Rs removes together with recursive targets when other targets are removed too
+    QVector<int> unusedDependencies(const QVector<int> &removed, const QVector<int> &recursive) const;
+    qint64 installedSize(const QVector<int> &ids) const;
+
+private:
+    // Adjacency list of package is a range of edges between its offset and the offset of the next package
+    struct Edges {
+        QVector<int> offsets;
+        QVector<int> targets;
+
+        QVector<int> adjacent(int id) const;
+        Edges transposed(int size) const;
+    };
+
+    QVector<int> resolve(const QString &dependName, bool installed) const;
+    Edges collectEdges(const QVector<QVector<QString>> &dependNames) const;
+
+    QVector<QString> m_names;
+    QHash<QString, int> m_ids;
+    QHash<QString, QVector<int>> m_providers;
+    QVector<bool> m_installed;
+    QVector<bool> m_explicit;
+    QVector<qint64> m_installedSizes;
+
+    Edges m_depends;
+    Edges m_optdepends;
+    Edges m_requiredBy;
+    Edges m_optionalFor;
+};
+
+#endif // DEPENDENCYGRAPH_H
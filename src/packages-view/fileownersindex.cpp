@@ -0,0 +1,230 @@
+#include "fileownersindex.h"
+#include "packagessnapshot.h"
+#include "../pacmansettings.h"
+
+#include <QStandardPaths>
+#include <QByteArrayMatcher>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QDebug>
+
+#include <alpm.h>
+
+#include <algorithm>
+#include <cstring>
+
+constexpr char INDEX_MAGIC[8] = {'O', 'R', 'S', 'N', 'F', 'I', 'D', 'X'};
+constexpr int MAX_OWNERS = 5000;
+
+namespace {
+// All offsets are relative to the beginning of strings, arrays follow the header and the key
+struct IndexHeader {
+    char magic[8];
+    quint32 keySize;
+    quint32 entriesCount;
+    quint32 ownersCount;
+    quint32 pathsSize;
+    quint32 stringsSize;
+};
+
+struct FileEntry {
+    const char *path;
+    quint32 owner;
+};
+}
+
+QString FileOwnersIndex::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/file-owners.idx";
+}
+
+// Files databases are updated separately from packages databases with pacman -Fy
+QByteArray FileOwnersIndex::databasesKey(const PacmanSettings &settings)
+{
+    QByteArray key = PackagesSnapshot::databasesKey(settings);
+    const QDir syncDir(QDir(settings.databasesPath()).filePath("sync"));
+    foreach (const QFileInfo &database, syncDir.entryInfoList({"*.files"}, QDir::Files, QDir::Name))
+        key += ';' + database.fileName().toUtf8() + ':' + QByteArray::number(database.lastModified().toMSecsSinceEpoch());
+
+    return key;
+}
+
+bool FileOwnersIndex::build(const QString &fileName, const QByteArray &key, const PacmanSettings &settings)
+{
+    // Separate handle reads file lists from .files databases instead of .db
+    alpm_errno_t error = ALPM_ERR_OK;
+    alpm_handle_t *handle = alpm_initialize(qPrintable(settings.rootDir()), qPrintable(settings.databasesPath()), &error);
+    if (error != ALPM_ERR_OK) {
+        qDebug() << alpm_strerror(error);
+        return false;
+    }
+    alpm_option_set_dbext(handle, ".files");
+
+    QVector<alpm_db_t *> databases = {alpm_get_localdb(handle)};
+    foreach (const QString &databaseName, settings.repositories()) {
+        alpm_db_t *database = alpm_register_syncdb(handle, qPrintable(databaseName), 0);
+        if (database != nullptr)
+            databases.append(database);
+    }
+
+    // Paths point into file lists of the handle, folders are skipped to keep the index compact
+    QVector<FileEntry> entries;
+    QVector<QByteArray> ownerNames;
+    QHash<QByteArray, quint32> ownerIds;
+    for (alpm_db_t *database : databases) {
+        for (alpm_list_t *item = alpm_db_get_pkgcache(database); item != nullptr; item = item->next) {
+            auto *packageData = static_cast<alpm_pkg_t *>(item->data);
+            const alpm_filelist_t *files = alpm_pkg_get_files(packageData);
+            if (files == nullptr || files->count == 0)
+                continue;
+
+            const QByteArray name = alpm_pkg_get_name(packageData);
+            auto ownerIt = ownerIds.find(name);
+            if (ownerIt == ownerIds.end()) {
+                ownerIt = ownerIds.insert(name, static_cast<quint32>(ownerNames.size()));
+                ownerNames.append(name);
+            }
+
+            for (size_t i = 0; i < files->count; ++i) {
+                const char *path = files->files[i].name;
+                if (path[std::strlen(path) - 1] != '/')
+                    entries.append({path, ownerIt.value()});
+            }
+        }
+    }
+
+    // Installed packages are also present in sync databases
+    std::sort(entries.begin(), entries.end(), [](const FileEntry &first, const FileEntry &second) {
+        const int compare = std::strcmp(first.path, second.path);
+        return compare < 0 || (compare == 0 && first.owner < second.owner);
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const FileEntry &first, const FileEntry &second) {
+        return first.owner == second.owner && std::strcmp(first.path, second.path) == 0;
+    }), entries.end());
+
+    QByteArray strings;
+    QVector<quint32> pathOffsets;
+    QVector<quint32> owners;
+    pathOffsets.reserve(entries.size());
+    owners.reserve(entries.size());
+    for (const FileEntry &entry : qAsConst(entries)) {
+        pathOffsets.append(static_cast<quint32>(strings.size()));
+        owners.append(entry.owner);
+        strings.append(entry.path);
+        strings.append('\0');
+    }
+    const auto pathsSize = static_cast<quint32>(strings.size());
+
+    QVector<quint32> ownerNameOffsets;
+    ownerNameOffsets.reserve(ownerNames.size());
+    for (const QByteArray &name : qAsConst(ownerNames)) {
+        ownerNameOffsets.append(static_cast<quint32>(strings.size()));
+        strings.append(name);
+        strings.append('\0');
+    }
+    alpm_release(handle);
+
+    IndexHeader header{};
+    std::copy(std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC), header.magic);
+    header.keySize = static_cast<quint32>(key.size());
+    header.entriesCount = static_cast<quint32>(pathOffsets.size());
+    header.ownersCount = static_cast<quint32>(ownerNameOffsets.size());
+    header.pathsSize = pathsSize;
+    header.stringsSize = static_cast<quint32>(strings.size());
+
+    QDir().mkpath(QFileInfo(fileName).path());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << file.errorString();
+        return false;
+    }
+
+    // Key is padded to keep arrays aligned
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(key + QByteArray((4 - key.size() % 4) % 4, '\0'));
+    file.write(reinterpret_cast<const char *>(pathOffsets.constData()), pathOffsets.size() * static_cast<int>(sizeof(quint32)));
+    file.write(reinterpret_cast<const char *>(owners.constData()), owners.size() * static_cast<int>(sizeof(quint32)));
+    file.write(reinterpret_cast<const char *>(ownerNameOffsets.constData()), ownerNameOffsets.size() * static_cast<int>(sizeof(quint32)));
+    file.write(strings);
+    return file.commit();
+}
+
+bool FileOwnersIndex::open(const QString &fileName, const QByteArray &key)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly) || static_cast<size_t>(m_file.size()) < sizeof(IndexHeader))
+        return false;
+
+    const uchar *data = m_file.map(0, m_file.size());
+    if (data == nullptr)
+        return false;
+
+    IndexHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const qint64 keyEnd = static_cast<qint64>(sizeof(header)) + header.keySize + (4 - header.keySize % 4) % 4;
+    const qint64 expectedSize = keyEnd + (static_cast<qint64>(header.entriesCount) * 2 + header.ownersCount) * static_cast<qint64>(sizeof(quint32)) + header.stringsSize;
+    if (!std::equal(std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC), header.magic) || expectedSize != m_file.size())
+        return false;
+
+    const char *indexKey = reinterpret_cast<const char *>(data) + sizeof(header);
+    if (QByteArray::fromRawData(indexKey, static_cast<int>(header.keySize)) != key)
+        return false;
+
+    m_pathOffsets = reinterpret_cast<const quint32 *>(data + keyEnd);
+    m_owners = m_pathOffsets + header.entriesCount;
+    m_ownerNameOffsets = m_owners + header.entriesCount;
+    m_strings = reinterpret_cast<const char *>(m_ownerNameOffsets + header.ownersCount);
+    m_entriesCount = header.entriesCount;
+    m_pathsSize = header.pathsSize;
+    return true;
+}
+
+QStringList FileOwnersIndex::find(const QString &query) const
+{
+    QByteArray pattern = QFile::encodeName(query.trimmed());
+    const bool absolute = pattern.startsWith('/');
+    if (absolute)
+        pattern.remove(0, 1);
+    if (pattern.isEmpty())
+        return {};
+
+    const quint32 *pathOffsetsEnd = m_pathOffsets + m_entriesCount;
+    QSet<quint32> owners;
+    if (absolute) {
+        // Paths are sorted, so all paths with the prefix are adjacent
+        const quint32 *offset = std::lower_bound(m_pathOffsets, pathOffsetsEnd, pattern, [this](quint32 offset, const QByteArray &pattern) {
+            return std::strcmp(string(offset), pattern.constData()) < 0;
+        });
+        for (; offset != pathOffsetsEnd && owners.size() < MAX_OWNERS; ++offset) {
+            if (std::strncmp(string(*offset), pattern.constData(), static_cast<size_t>(pattern.size())) != 0)
+                break;
+            owners.insert(m_owners[offset - m_pathOffsets]);
+        }
+    } else {
+        // Scan all paths at once and continue from the next path after a match
+        const QByteArray paths = QByteArray::fromRawData(m_strings, static_cast<int>(m_pathsSize));
+        const QByteArrayMatcher matcher(pattern);
+        int position = matcher.indexIn(paths);
+        while (position != -1 && owners.size() < MAX_OWNERS) {
+            const quint32 *offset = std::upper_bound(m_pathOffsets, pathOffsetsEnd, static_cast<quint32>(position)) - 1;
+            owners.insert(m_owners[offset - m_pathOffsets]);
+            if (offset + 1 == pathOffsetsEnd)
+                break;
+            position = matcher.indexIn(paths, static_cast<int>(offset[1]));
+        }
+    }
+
+    QStringList names;
+    names.reserve(owners.size());
+    for (quint32 owner : qAsConst(owners))
+        names.append(QString::fromUtf8(string(m_ownerNameOffsets[owner])));
+
+    return names;
+}
+
+const char *FileOwnersIndex::string(quint32 offset) const
+{
+    return m_strings + offset;
+}
@@ -0,0 +1,39 @@
+#ifndef FILEOWNERSINDEX_H
+#define FILEOWNERSINDEX_H
+
+#include <QFile>
+#include <QStringList>
+
+class PacmanSettings;
+
+// Sorted paths of files from local and sync .files databases with their packages, used from mapped memory
+class FileOwnersIndex
+{
+    Q_DISABLE_COPY(FileOwnersIndex)
+
+public:
+    FileOwnersIndex() = default;
+
+    static QString defaultFileName();
+    static QByteArray databasesKey(const PacmanSettings &settings);
+    static bool build(const QString &fileName, const QByteArray &key, const PacmanSettings &settings);
+
+    // Fails if the index was built for other databases
+    bool open(const QString &fileName, const QByteArray &key);
+
+    // Absolute paths are matched by prefix, other queries by substring
+    QStringList find(const QString &query) const;
+
+private:
+    const char *string(quint32 offset) const;
+
+    QFile m_file;
+    const quint32 *m_pathOffsets = nullptr;
+    const quint32 *m_owners = nullptr;
+    const quint32 *m_ownerNameOffsets = nullptr;
+    const char *m_strings = nullptr;
+    quint32 m_entriesCount = 0;
+    quint32 m_pathsSize = 0;
+};
+
+#endif // FILEOWNERSINDEX_H
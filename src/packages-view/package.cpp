@@ -23,24 +23,23 @@ void Package::setLocalData(alpm_pkg_t *data)
 void Package::setAurData(const QJsonObject &object, bool full)
 {
     m_aurData = object;
+    m_aurVersion = PackageVersion(m_aurData.value("Version").toString());
     m_fullAurInfo = full;
 }
 
-bool Package::sameName(alpm_pkg_t *otherData)
+// Read frequently used fields from the table instead of ALPM
+void Package::setTableRow(const QSharedPointer<const PackagesTable> &table, int id)
 {
-    const char *text = alpm_pkg_get_name(otherData);
-
-    if (m_localData != nullptr)
-        return qstrcmp(text, alpm_pkg_get_name(m_localData)) == 0;
-
-    if (m_syncData != nullptr)
-        return qstrcmp(text, alpm_pkg_get_name(m_syncData)) == 0;
-
-    return false;
+    m_table = table;
+    m_id = id;
+    m_installed = m_table->isInstalled(m_id);
 }
 
 QString Package::name() const
 {
+    if (m_table != nullptr)
+        return m_table->name(m_id);
+
     if (m_localData != nullptr)
         return alpm_pkg_get_name(m_localData);
 
@@ -52,6 +51,14 @@ QString Package::name() const
 
 QString Package::repo() const
 {
+    if (m_table != nullptr) {
+        // Foreign packages receive AUR data after the table is filled
+        if (!m_aurData.isEmpty() && m_table->repo(m_id) == QLatin1String("local"))
+            return QStringLiteral("aur");
+
+        return m_table->repo(m_id);
+    }
+
     if (m_syncData != nullptr)
         return alpm_db_get_name(alpm_pkg_get_db(m_syncData));
 
@@ -63,6 +70,9 @@ QString Package::repo() const
 
 QString Package::version() const
 {
+    if (m_table != nullptr)
+        return m_table->version(m_id);
+
     if (m_localData != nullptr)
         return alpm_pkg_get_version(m_localData);
 
@@ -72,30 +82,42 @@ QString Package::version() const
     return m_aurData.value("Version").toString();
 }
 
+PackageVersion Package::parsedVersion() const
+{
+    if (m_table != nullptr)
+        return m_table->parsedVersion(m_id);
+
+    return PackageVersion(version());
+}
+
 QString Package::availableUpdate() const
 {
-    if (m_localData == nullptr)
+    if (!m_installed)
         return QString();
 
-    const char *localVersion = alpm_pkg_get_version(m_localData);
-
-    // Check version in remote repository
-    if (m_syncData != nullptr) {
+    // Update from repository is checked once when the table is filled
+    if (m_table != nullptr) {
+        if (!m_table->availableUpdate(m_id).isEmpty())
+            return m_table->availableUpdate(m_id);
+    } else if (m_syncData != nullptr) {
+        // Check version in remote repository
         const char *repoVersion = alpm_pkg_get_version(m_syncData);
-        if (qstrcmp(localVersion, repoVersion) < 0)
+        if (alpm_pkg_vercmp(alpm_pkg_get_version(m_localData), repoVersion) < 0)
             return repoVersion;
     }
 
     // Check version in AUR
-    const QString aurVersion = m_aurData.value("Version").toString();
-    if (aurVersion > localVersion)
-        return aurVersion;
+    if (!m_aurData.isEmpty() && m_aurVersion > parsedVersion())
+        return m_aurData.value("Version").toString();
 
     return QString();
 }
 
 QString Package::description() const
 {
+    if (m_table != nullptr)
+        return m_table->description(m_id);
+
     if (m_localData != nullptr)
         return alpm_pkg_get_desc(m_localData);
 
@@ -202,12 +224,32 @@ QStringList Package::files() const
     else
         filesList = alpm_pkg_get_files(m_localData);
 
+    // Not available for packages from snapshot
+    if (filesList == nullptr)
+        return files;
+
     for (size_t i = 0; i < filesList->count; ++i)
         files.append(filesList->files[i].name);
 
     return files;
 }
 
+// Configuration files which are expected to be edited by user
+QStringList Package::backupFiles() const
+{
+    QStringList files;
+    if (m_localData == nullptr)
+        return files;
+
+    alpm_list_t *backupList = alpm_pkg_get_backup(m_localData);
+    while (backupList != nullptr) {
+        files.append(static_cast<const alpm_backup_t *>(backupList->data)->name);
+        backupList = backupList->next;
+    }
+
+    return files;
+}
+
 QStringList Package::keywords() const
 {
     QStringList keywords;
@@ -342,6 +384,9 @@ long Package::downloadSize() const
 
 long Package::installedSize() const
 {
+    if (m_table != nullptr)
+        return m_table->installedSize(m_id);
+
     if (m_localData != nullptr)
         return alpm_pkg_get_isize(m_localData);
 
@@ -364,6 +409,9 @@ bool Package::isInstalled() const
 // Can be obtained only from local data
 bool Package::isInstalledExplicitly() const
 {
+    if (m_table != nullptr)
+        return m_table->isInstalledExplicitly(m_id);
+
     if (m_localData == nullptr)
         return false;
 
@@ -373,6 +421,9 @@ bool Package::isInstalledExplicitly() const
 // Can be obtained only from local data
 bool Package::hasScript() const
 {
+    if (m_localData == nullptr)
+        return false;
+
     return alpm_pkg_has_scriptlet(m_localData);
 }
 
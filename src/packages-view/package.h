@@ -2,10 +2,12 @@
 #define PACKAGE_H
 
 #include "depend.h"
+#include "packagestable.h"
 
 #include <QDateTime>
 #include <QJsonObject>
 #include <QIcon>
+#include <QSharedPointer>
 
 class __alpm_pkg_t;
 class __alpm_list_t;
@@ -17,15 +19,17 @@ class Package
 public:
     Package() = default;
     explicit Package(const Package &other) = default;
+    Package &operator=(const Package &other) = default;
 
     void setSyncData(alpm_pkg_t *data);
     void setLocalData(alpm_pkg_t *data);
     void setAurData(const QJsonObject &object, bool full = false);
-    bool sameName(alpm_pkg_t *otherData);
+    void setTableRow(const QSharedPointer<const PackagesTable> &table, int id);
 
     QString name() const;
     QString repo() const;
     QString version() const;
+    PackageVersion parsedVersion() const;
     QString availableUpdate() const;
     QString description() const;
     QString arch() const;
@@ -36,6 +40,7 @@ public:
     QStringList licenses() const;
     QStringList groups() const;
     QStringList files() const;
+    QStringList backupFiles() const;
     QStringList keywords() const;
     QVector<Depend> provides() const;
     QVector<Depend> replaces() const;
@@ -67,6 +72,11 @@ private:
     alpm_pkg_t *m_syncData = nullptr;
     alpm_pkg_t *m_localData = nullptr;
     QJsonObject m_aurData;
+    PackageVersion m_aurVersion;
+
+    // Decoded fields for the packages list
+    QSharedPointer<const PackagesTable> m_table;
+    int m_id = -1;
 };
 
 #endif // PACKAGE_H
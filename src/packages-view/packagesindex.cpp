@@ -0,0 +1,138 @@
+#include "packagesindex.h"
+
+#include <algorithm>
+#include <numeric>
+
+constexpr int TRIGRAM_SIZE = 3;
+
+static quint64 trigramKey(const QChar *chars)
+{
+    return static_cast<quint64>(chars[0].unicode()) << 32
+            | static_cast<quint64>(chars[1].unicode()) << 16
+            | chars[2].unicode();
+}
+
+static QVector<int> intersect(const QVector<int> &first, const QVector<int> &second)
+{
+    QVector<int> result;
+    std::set_intersection(first.cbegin(), first.cend(), second.cbegin(), second.cend(), std::back_inserter(result));
+    return result;
+}
+
+static QVector<int> unite(const QVector<int> &first, const QVector<int> &second)
+{
+    QVector<int> result;
+    result.reserve(first.size() + second.size());
+    std::set_union(first.cbegin(), first.cend(), second.cbegin(), second.cend(), std::back_inserter(result));
+    return result;
+}
+
+void PackagesIndex::reserve(int size)
+{
+    m_names.reserve(size);
+    m_descriptions.reserve(size);
+    m_maintainers.reserve(size);
+}
+
+int PackagesIndex::size() const
+{
+    return m_names.size();
+}
+
+int PackagesIndex::append(const QString &name, const QString &description, const QString &maintainer)
+{
+    m_names.append(name);
+    m_descriptions.append(description);
+    m_maintainers.append(maintainer);
+
+    return m_names.size() - 1;
+}
+
+void PackagesIndex::build()
+{
+    for (int id = 0; id < m_names.size(); ++id) {
+        addTrigrams(m_namePostings, m_names.at(id), id);
+        addTrigrams(m_descriptionPostings, m_descriptions.at(id), id);
+        addTrigrams(m_maintainerPostings, m_maintainers.at(id), id);
+    }
+}
+
+QVector<int> PackagesIndex::find(const QStringList &terms, Fields fields) const
+{
+    // Narrow candidates by trigrams of each term, terms shorter than trigram can't narrow them
+    QVector<int> candidates;
+    bool narrowed = false;
+    foreach (const QString &term, terms) {
+        if (term.size() < TRIGRAM_SIZE)
+            continue;
+
+        QVector<int> termCandidates;
+        if (fields.testFlag(Name))
+            termCandidates = unite(termCandidates, findTrigrams(m_namePostings, term));
+        if (fields.testFlag(Description))
+            termCandidates = unite(termCandidates, findTrigrams(m_descriptionPostings, term));
+        if (fields.testFlag(Maintainer))
+            termCandidates = unite(termCandidates, findTrigrams(m_maintainerPostings, term));
+
+        candidates = narrowed ? intersect(candidates, termCandidates) : termCandidates;
+        narrowed = true;
+        if (candidates.isEmpty())
+            return candidates;
+    }
+
+    if (!narrowed) {
+        candidates.resize(m_names.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
+    // Trigrams can match in different places of the text, so check candidates for whole terms
+    QVector<int> ids;
+    for (int id : qAsConst(candidates)) {
+        const bool found = std::all_of(terms.cbegin(), terms.cend(), [this, id, fields](const QString &term) {
+            return contains(id, term, fields);
+        });
+        if (found)
+            ids.append(id);
+    }
+
+    return ids;
+}
+
+void PackagesIndex::addTrigrams(Postings &postings, const QString &text, int id)
+{
+    for (int i = 0; i + TRIGRAM_SIZE <= text.size(); ++i) {
+        // Rows are added in ascending order, so repeated trigram of the same row is always the last one
+        QVector<int> &ids = postings[trigramKey(text.constData() + i)];
+        if (ids.isEmpty() || ids.constLast() != id)
+            ids.append(id);
+    }
+}
+
+// Ids of rows that contain all trigrams of the term in a field
+QVector<int> PackagesIndex::findTrigrams(const Postings &postings, const QString &term)
+{
+    // Start from the rarest trigram to keep intersections small
+    QVector<const QVector<int> *> lists;
+    for (int i = 0; i + TRIGRAM_SIZE <= term.size(); ++i) {
+        const auto it = postings.constFind(trigramKey(term.constData() + i));
+        if (it == postings.cend())
+            return QVector<int>();
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *first, const QVector<int> *second) {
+        return first->size() < second->size();
+    });
+
+    QVector<int> ids = *lists.constFirst();
+    for (int i = 1; i < lists.size() && !ids.isEmpty(); ++i)
+        ids = intersect(ids, *lists.at(i));
+
+    return ids;
+}
+
+bool PackagesIndex::contains(int id, const QString &term, Fields fields) const
+{
+    return (fields.testFlag(Name) && m_names.at(id).contains(term))
+            || (fields.testFlag(Description) && m_descriptions.at(id).contains(term))
+            || (fields.testFlag(Maintainer) && m_maintainers.at(id).contains(term));
+}
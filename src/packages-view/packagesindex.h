@@ -0,0 +1,49 @@
+#ifndef PACKAGESINDEX_H
+#define PACKAGESINDEX_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// Inverted index of packages fields trigrams to answer search queries without scanning all packages
+class PackagesIndex
+{
+public:
+    enum Field {
+        Name = 0x1,
+        Description = 0x2,
+        Maintainer = 0x4
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    void reserve(int size);
+    int size() const;
+
+    // Add row with searchable fields and return its id
+    int append(const QString &name, const QString &description, const QString &maintainer);
+
+    // Fill trigrams lists, should be called once after all rows are added
+    void build();
+
+    // Ids of rows that contain every term in at least one of the fields in ascending order
+    QVector<int> find(const QStringList &terms, Fields fields) const;
+
+private:
+    using Postings = QHash<quint64, QVector<int>>;
+
+    static void addTrigrams(Postings &postings, const QString &text, int id);
+    static QVector<int> findTrigrams(const Postings &postings, const QString &term);
+    bool contains(int id, const QString &term, Fields fields) const;
+
+    QVector<QString> m_names;
+    QVector<QString> m_descriptions;
+    QVector<QString> m_maintainers;
+
+    Postings m_namePostings;
+    Postings m_descriptionPostings;
+    Postings m_maintainerPostings;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(PackagesIndex::Fields)
+
+#endif // PACKAGESINDEX_H
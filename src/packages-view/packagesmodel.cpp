@@ -1,21 +1,35 @@
 #include "packagesmodel.h"
 #include "package.h"
+#include "aurclient.h"
+#include "packagessnapshot.h"
+#include "fileownersindex.h"
+#include "dependencygraph.h"
 #include "../pacmansettings.h"
 
-#include <QNetworkReply>
-#include <QEventLoop>
-#include <QJsonDocument>
+#include <QJsonObject>
 #include <QJsonArray>
 
+#include <algorithm>
 #include <execution>
+#include <numeric>
 
-constexpr char AUR_API_URL[] = "https://aur.archlinux.org/rpc/";
+constexpr int PACKAGES_CHUNK_SIZE = 2048;
+
+struct SyncDatabase {
+    QByteArray name;
+    alpm_handle_t *handle;
+    QVector<alpm_pkg_t *> packages;
+};
 
 PackagesModel::PackagesModel(QObject *parent) :
     QAbstractItemModel(parent)
 {
-    m_manager = new QNetworkAccessManager(this);
+    m_aurClient = new AurClient(this);
+    connect(m_aurClient, &AurClient::searchFinished, this, &PackagesModel::processAurSearch);
+    connect(m_aurClient, &AurClient::detailsLoaded, this, &PackagesModel::processAurDetails);
+    connect(m_aurClient, &AurClient::infoLoaded, this, &PackagesModel::processForeignPackagesInfo);
     qRegisterMetaType<DatabaseStatus>("DatabaseStatus"); // To allow use databaseStatusChanged signal
+    loadSnapshot();
     reloadRepoPackages();
 }
 
@@ -23,9 +37,15 @@ PackagesModel::~PackagesModel()
 {
     m_loadingDatabases.cancel();
     m_loadingDatabases.waitForFinished();
+    m_buildingSearchIndex.waitForFinished();
+    m_filtering.waitForFinished();
+    m_loadingFileOwnersIndex.waitForFinished();
+    m_calculatingRemoval.waitForFinished();
 
     qDeleteAll(m_repoPackages);
     qDeleteAll(m_aurPackages);
+    foreach (const QVector<Package *> &chunk, m_pendingPackages)
+        qDeleteAll(chunk);
 }
 
 QVariant PackagesModel::data(const QModelIndex &index, int role) const
@@ -128,8 +148,8 @@ QModelIndex PackagesModel::index(int row, int column, const QModelIndex &) const
 {
     switch (m_mode) {
     case Repo:
-        if (row < m_repoPackages.size())
-            return createIndex(row, column, m_repoPackages.at(row));
+        if (row < displayedPackages().size())
+            return createIndex(row, column, displayedPackages().at(row));
         break;
     case AUR:
         if (row < m_aurPackages.size())
@@ -149,7 +169,7 @@ int PackagesModel::rowCount(const QModelIndex &) const
 {
     switch (m_mode) {
     case Repo:
-        return m_repoPackages.size();
+        return displayedPackages().size();
     case AUR:
         return m_aurPackages.size();
     }
@@ -173,32 +193,32 @@ void PackagesModel::sort(int column, Qt::SortOrder order)
     case Repo:
         switch (column) {
         case 0:
-            sortPackages(m_repoPackages, order, &Package::isInstalled, &Package::name);
+            sortPackages(m_repoPackages, order, &Package::isInstalled);
             break;
         case 1:
             sortPackages(m_repoPackages, order, &Package::name);
             break;
         case 2:
-            sortPackages(m_repoPackages, order, &Package::version, &Package::name);
+            sortPackages(m_repoPackages, order, &Package::parsedVersion);
             break;
         case 3:
             sortPackages(m_repoPackages, order, &Package::installedSize);
             break;
         case 4:
-            sortPackages(m_repoPackages, order, &Package::repo, &Package::name);
+            sortPackages(m_repoPackages, order, &Package::repo);
             break;
         }
         break;
     case AUR:
         switch (column) {
         case 0:
-            sortPackages(m_aurPackages, order, &Package::isInstalled, &Package::name);
+            sortPackages(m_aurPackages, order, &Package::isInstalled);
             break;
         case 1:
             sortPackages(m_aurPackages, order, &Package::name);
             break;
         case 2:
-            sortPackages(m_aurPackages, order, &Package::version, &Package::name);
+            sortPackages(m_aurPackages, order, &Package::parsedVersion);
             break;
         case 3:
             sortPackages(m_aurPackages, order, &Package::popularity);
@@ -207,21 +227,25 @@ void PackagesModel::sort(int column, Qt::SortOrder order)
         break;
     }
 
+    // Filtered packages follow the order of all packages
+    if (m_mode == Repo) {
+        updatePositions(0);
+        if (m_filtered)
+            sortByPositions(m_filteredPackages);
+    }
+
+    // Map packages to their new positions
+    QHash<const Package *, int> rows;
+    const QVector<Package *> &sortedPackages = m_mode == Repo ? displayedPackages() : m_aurPackages;
+    rows.reserve(sortedPackages.size());
+    for (int i = 0; i < sortedPackages.size(); ++i)
+        rows.insert(sortedPackages.at(i), i);
+
     // Update indexes
     QModelIndexList newIndexes;
     foreach (const QModelIndex &oldIndex, oldIndexes) {
         auto *package = static_cast<Package *>(oldIndex.internalPointer()); // Get package from old index
-
-        // Find new package position
-        int row = 0;
-        switch (m_mode) {
-        case Repo:
-            row = m_repoPackages.indexOf(package);
-            break;
-        case AUR:
-            row = m_aurPackages.indexOf(package);
-            break;
-        }
+        const int row = rows.value(package);
 
         // Save index
         const QModelIndex newIndex = index(row, oldIndex.column());
@@ -253,7 +277,7 @@ QVector<Package *> PackagesModel::packages() const
 {
     switch (m_mode) {
     case Repo:
-        return m_repoPackages;
+        return displayedPackages();
     case AUR:
         return m_aurPackages;
     }
@@ -266,237 +290,973 @@ QVector<Package *> PackagesModel::outdatedPackages() const
     return m_outdatedPackages;
 }
 
-void PackagesModel::reloadRepoPackages()
+QVector<Package *> PackagesModel::installedPackages() const
 {
-    m_loadingDatabases = QtConcurrent::run(this, &PackagesModel::loadDatabases);
+    return m_installedPackages;
 }
 
-void PackagesModel::aurQuery(const QString &text, const QString &searchType)
+Package *PackagesModel::findPackage(const QString &packageName) const
+{
+    return m_repoPackagesIndex.value(packageName);
+}
+
+QVector<Package *> PackagesModel::findProviders(const QString &packageName) const
+{
+    return m_providersIndex.value(packageName);
+}
+
+// Packages are returned by names because the graph is available only after loading
+QStringList PackagesModel::requiredBy(const QString &packageName) const
+{
+    if (m_dependencyGraph == nullptr)
+        return {};
+
+    return m_dependencyGraph->names(m_dependencyGraph->requiredBy(m_dependencyGraph->id(packageName)));
+}
+
+QStringList PackagesModel::optionalFor(const QString &packageName) const
 {
-    // Generate API URL
-    QUrl url(AUR_API_URL);
-    url.setQuery("v=5&type=search&by=" + searchType + "&arg=" + text);
+    if (m_dependencyGraph == nullptr)
+        return {};
+
+    return m_dependencyGraph->names(m_dependencyGraph->optionalFor(m_dependencyGraph->id(packageName)));
+}
 
-    // Get request
-    QScopedPointer reply(m_manager->get(QNetworkRequest(url)));
-    QEventLoop waitForReply;
-    connect(reply.get(), &QNetworkReply::finished, &waitForReply, &QEventLoop::quit);
-    waitForReply.exec();
+QVector<Package *> PackagesModel::orphans(bool optdependsRequired) const
+{
+    QVector<Package *> packages;
+    if (m_dependencyGraph == nullptr)
+        return packages;
+
+    for (int id : m_dependencyGraph->unneeded(optdependsRequired)) {
+        Package *package = m_installedPackagesIndex.value(m_dependencyGraph->name(id));
+        if (package != nullptr)
+            packages.append(package);
+    }
 
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << reply->errorString();
+    return packages;
+}
+
+// Calculation takes milliseconds, so the previous one is just waited for and its result is skipped
+void PackagesModel::calculateRemovalImpact(const QStringList &uninstall, const QStringList &uninstallWithUnused)
+{
+    m_calculatingRemoval.waitForFinished();
+    const int generation = ++m_removalGeneration;
+    if (m_dependencyGraph == nullptr || (uninstall.isEmpty() && uninstallWithUnused.isEmpty())) {
+        emit removalImpactCalculated(0, 0, QStringList());
         return;
     }
 
-    // Parse data
-    const QJsonObject jsonData = QJsonDocument::fromJson(reply->readAll()).object();
-    const QJsonObject packageData = jsonData.value("results").toArray().at(0).toObject();
+    const QSharedPointer<const DependencyGraph> dependencyGraph = m_dependencyGraph;
+    m_calculatingRemoval = QtConcurrent::run([this, dependencyGraph, uninstall, uninstallWithUnused, generation] {
+        QVector<int> removed;
+        foreach (const QString &packageName, uninstall)
+            removed.append(dependencyGraph->id(packageName));
+        QVector<int> recursive;
+        foreach (const QString &packageName, uninstallWithUnused)
+            recursive.append(dependencyGraph->id(packageName));
+
+        const QVector<int> unused = dependencyGraph->unusedDependencies(removed, recursive);
+        const qint64 targetsSize = dependencyGraph->installedSize(removed + recursive);
+        const qint64 unusedSize = dependencyGraph->installedSize(unused);
+        const QStringList unusedPackages = dependencyGraph->names(unused);
+        QMetaObject::invokeMethod(this, [this, targetsSize, unusedSize, unusedPackages, generation] {
+            if (generation == m_removalGeneration)
+                emit removalImpactCalculated(targetsSize, unusedSize, unusedPackages);
+        }, Qt::QueuedConnection);
+    });
+}
 
-    beginResetModel();
+// Index is invalid if the package is hidden by the filter or not displayed in the current mode
+QModelIndex PackagesModel::packageIndex(const Package *package, int column) const
+{
+    if (m_mode != Repo)
+        return QModelIndex();
 
-    // Clear old data
-    qDeleteAll(m_aurPackages);
-    m_aurPackages.clear();
+    const int row = displayedRow(package);
+    if (row == -1)
+        return QModelIndex();
 
-    foreach (const QJsonValue &aurPackageData, jsonData.value("results").toArray()) {
-        // Check if package already installed
-        bool found = false;
-        const QString packageName = aurPackageData.toObject().value("Name").toString();
-        foreach (Package *package, m_repoPackages) {
-            if (!package->isInstalled() || package->name() != packageName)
-                continue;
-
-            auto *aurPackage = new Package(*package);
-            m_aurPackages.append(aurPackage);
-            found = true;
-            break;
-        }
+    return index(row, column);
+}
 
-        if (!found) {
-            // Create new package
-            auto *package = new Package;
-            package->setAurData(aurPackageData.toObject());
-            m_aurPackages.append(package);
-        }
+// Find packages that contain every term in at least one of the fields
+QVector<Package *> PackagesModel::findPackages(const QStringList &terms, PackagesIndex::Fields fields) const
+{
+    QVector<Package *> packages;
+    if (m_searchIndex != nullptr) {
+        foreach (int id, m_searchIndex->find(terms, fields))
+            packages.append(m_indexedPackages.at(id));
+        return packages;
     }
 
-    endResetModel();
+    // Index is not built yet, scan all packages
+    foreach (Package *package, m_repoPackages) {
+        if (containsTerms(*package, terms, fields))
+            packages.append(package);
+    }
+
+    return packages;
 }
 
-void PackagesModel::loadMoreAurInfo(Package *package)
+// Show only packages that contain every term, rows are changed with a single layout change
+void PackagesModel::setFilter(const QStringList &terms, PackagesIndex::Fields fields)
 {
-    // Check if full AUR info already loaded
-    if (package->fullAurInfo())
+    m_searchTimer.start();
+    ++m_filterGeneration;
+    m_orphansFiltered = false;
+    m_fileFilter.clear();
+
+    // Clearing is cheap and the linear fallback is used only while the index is not ready yet
+    if (terms.isEmpty() || m_searchIndex == nullptr) {
+        m_filterPending = false;
+        applyFilter(terms, fields, terms.isEmpty() ? QVector<Package *>() : findPackages(terms, fields));
         return;
+    }
 
-    QUrl url(AUR_API_URL);
-    url.setQuery("v=5&type=info&arg[]=" + package->name());
+    // Only the latest query is started after the running one, intermediate queries are skipped
+    m_pendingFilterTerms = terms;
+    m_pendingFilterFields = fields;
+    m_pendingFileFilter = false;
+    if (m_filtering.isRunning()) {
+        m_filterPending = true;
+        return;
+    }
+    startFiltering();
+}
 
-    QScopedPointer reply(m_manager->get(QNetworkRequest(url)));
-    QEventLoop waitForReply;
-    connect(reply.get(), &QNetworkReply::finished, &waitForReply, &QEventLoop::quit);
-    waitForReply.exec();
+void PackagesModel::setFileFilter(const QString &path)
+{
+    m_searchTimer.start();
+    ++m_filterGeneration;
+    m_orphansFiltered = false;
+    m_fileFilter = path.trimmed();
+
+    if (m_fileFilter.isEmpty()) {
+        m_filterPending = false;
+        applyFilter(QStringList(), PackagesIndex::Fields(), QVector<Package *>());
+        return;
+    }
+
+    m_pendingFilterTerms = QStringList(m_fileFilter);
+    m_pendingFilterFields = PackagesIndex::Fields();
+    m_pendingFileFilter = true;
+    m_filterPending = true;
 
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << reply->errorString();
+    // Files index is opened or built on the first search by files
+    if (m_fileOwnersIndex == nullptr) {
+        loadFileOwnersIndex();
         return;
     }
+    if (!m_filtering.isRunning())
+        startFiltering();
+}
 
-    // Parse data
-    const QJsonObject jsonData = QJsonDocument::fromJson(reply->readAll()).object();
-    const QJsonObject packageData = jsonData.value("results").toArray().at(0).toObject();
-    package->setAurData(packageData, true);
+// Orphans are found in a few milliseconds, so there is no need for background filtering
+void PackagesModel::setOrphansFilter(const QStringList &terms, bool optdependsRequired)
+{
+    m_searchTimer.start();
+    ++m_filterGeneration;
+    m_filterPending = false;
+    m_orphansFiltered = true;
+    m_fileFilter.clear();
+    m_optdependsRequired = optdependsRequired;
+
+    QVector<Package *> packages;
+    foreach (Package *package, orphans(optdependsRequired)) {
+        if (containsTerms(*package, terms, PackagesIndex::Name | PackagesIndex::Description))
+            packages.append(package);
+    }
+    applyFilter(terms, PackagesIndex::Name | PackagesIndex::Description, packages);
 }
 
-void PackagesModel::loadDatabases()
+void PackagesModel::startFiltering()
 {
-    setDatabaseStatus(Loading);
+    // Search by files waits for the index
+    if (m_pendingFileFilter && m_fileOwnersIndex == nullptr)
+        return;
+
+    m_filterPending = false;
+    const QStringList terms = m_pendingFilterTerms;
+    const PackagesIndex::Fields fields = m_pendingFilterFields;
+    if (!m_pendingFileFilter && m_searchIndex == nullptr) {
+        applyFilter(terms, fields, findPackages(terms, fields));
+        return;
+    }
+
+    // Indexes are immutable, so they can be queried without touching packages from the worker thread
+    const QSharedPointer<const PackagesIndex> searchIndex = m_searchIndex;
+    const QSharedPointer<const FileOwnersIndex> fileOwnersIndex = m_pendingFileFilter ? m_fileOwnersIndex : QSharedPointer<const FileOwnersIndex>();
+    const int generation = m_filterGeneration;
+    m_filtering = QtConcurrent::run([this, searchIndex, fileOwnersIndex, terms, fields, generation] {
+        QVector<int> ids;
+        QStringList owners;
+        if (fileOwnersIndex != nullptr)
+            owners = fileOwnersIndex->find(terms.first());
+        else
+            ids = searchIndex->find(terms, fields);
+
+        QMetaObject::invokeMethod(this, [this, searchIndex, fileOwnersIndex, terms, fields, generation, ids, owners] {
+            if (m_filterPending) {
+                startFiltering();
+                return;
+            }
+            if (generation != m_filterGeneration)
+                return;
+
+            // Files index knows only names of packages
+            if (fileOwnersIndex != nullptr) {
+                QVector<Package *> packages;
+                packages.reserve(owners.size());
+                foreach (const QString &owner, owners) {
+                    Package *package = m_repoPackagesIndex.value(owner);
+                    if (package != nullptr)
+                        packages.append(package);
+                }
+                applyFilter(terms, fields, packages);
+                return;
+            }
+
+            // Ids refer to the old index if packages were reloaded during the search
+            if (searchIndex != m_searchIndex) {
+                applyFilter(terms, fields, findPackages(terms, fields));
+                return;
+            }
+
+            QVector<Package *> packages;
+            packages.reserve(ids.size());
+            foreach (int id, ids)
+                packages.append(m_indexedPackages.at(id));
+            applyFilter(terms, fields, packages);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PackagesModel::applyFilter(const QStringList &terms, PackagesIndex::Fields fields, QVector<Package *> packages)
+{
+    const bool filtered = !terms.isEmpty() || m_orphansFiltered;
+    if (!filtered && !m_filtered) {
+        emit searchFinished(m_searchTimer.elapsed());
+        return;
+    }
+
+    emit layoutAboutToBeChanged();
+    const QModelIndexList oldIndexes = persistentIndexList();
+
+    m_filterTerms = terms;
+    m_filterFields = fields;
+    m_filtered = filtered;
+    m_filteredPackages = std::move(packages);
+    sortByPositions(m_filteredPackages);
+
+    // Hidden packages lose their indexes
+    QModelIndexList newIndexes;
+    foreach (const QModelIndex &oldIndex, oldIndexes) {
+        const int row = displayedRow(static_cast<Package *>(oldIndex.internalPointer()));
+        newIndexes.append(row == -1 ? QModelIndex() : index(row, oldIndex.column()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
 
-    if (m_handle != nullptr)
+    emit layoutChanged();
+    emit searchFinished(m_searchTimer.elapsed());
+}
+
+void PackagesModel::reloadRepoPackages(ReloadMode reloadMode)
+{
+    m_loadingDatabases.cancel();
+    m_loadingDatabases.waitForFinished();
+    m_aurClient->abortInfo();
+    ++m_loadingGeneration;
+
+    if (reloadMode == DeltaReload && !m_repoPackages.isEmpty()) {
+        dropPendingPackages();
+
+        // Displayed packages stay bound to the previous handle until loaded ones are merged into them
+        if (m_previousHandles.isEmpty())
+            m_previousHandles.swap(m_handles);
+        else
+            releaseHandles(m_handles);
+        m_mergeLoadedPackages = true;
+    } else if (!m_handles.isEmpty() || !m_previousHandles.isEmpty()) {
         resetDatabase();
+    }
+
+    m_loadingDatabases = QtConcurrent::run(this, &PackagesModel::loadDatabases, m_loadingGeneration);
+}
+
+void PackagesModel::aurQuery(const QString &text, const QString &searchType)
+{
+    m_searchTimer.start();
+    m_aurClient->search(text, searchType);
+}
+
+void PackagesModel::loadMoreAurInfo(Package *package)
+{
+    // Check if full AUR info already loaded
+    if (package->fullAurInfo())
+        return;
+
+    m_aurClient->loadDetails(package->name());
+}
+
+void PackagesModel::setOfflineAurSearch(bool enabled, const QString &archiveFile)
+{
+    m_aurClient->setOfflineSearch(enabled, archiveFile);
+}
+
+void PackagesModel::loadDatabases(int generation)
+{
+    setDatabaseStatus(Loading);
 
     // Initialize ALPM
     const PacmanSettings settings;
-    m_handle = alpm_initialize(qPrintable(settings.rootDir()), qPrintable(settings.databasesPath()), &m_error);
+    const QByteArray snapshotKey = PackagesSnapshot::databasesKey(settings);
+    alpm_handle_t *handle = alpm_initialize(qPrintable(settings.rootDir()), qPrintable(settings.databasesPath()), &m_error);
     if (m_error != ALPM_ERR_OK) {
         qDebug() << alpm_strerror(m_error);
         return;
     }
+    m_handles.append(handle);
 
     // Load packages
-    loadLocalDatabase();
-    foreach (const QString &repo, settings.repositories())
-        loadSyncDatabase(repo);
-    loadAurDatabase();
-    checkForUpdates(settings);
+    const QVector<Package *> installedPackages = loadLocalDatabase(handle);
+    const QVector<Package *> syncPackages = loadSyncDatabases(settings, installedPackages);
+    if (m_loadingDatabases.isCanceled()) {
+        qDeleteAll(installedPackages);
+        qDeleteAll(syncPackages);
+        return;
+    }
 
-    emit databaseLoadingMessageChanged(QString::number(m_repoPackages.size())
-                               + " packages avaible in official repositories, "
-                               + QString::number(m_installedPackages.size())
-                               + " packages installed, "
-                               + (m_outdatedPackages.empty() ? "no" : QString::number(m_outdatedPackages.size()))
-                               + " updates available");
+    const QVector<Package *> packages = installedPackages + syncPackages;
+    fillPackagesTable(packages);
+
+    // Installed packages go first, so the graph uses their dependencies
+    QSharedPointer<DependencyGraph> dependencyGraph(new DependencyGraph);
+    dependencyGraph->build(packages);
+
+    // Packages belong to the GUI thread after posting, so collect names for AUR request before it
+    QStringList foreignPackages;
+    for (Package *package : installedPackages) {
+        if (package->repo() == "local")
+            foreignPackages.append(package->name());
+    }
+    postPackages(packages);
+
+    QMetaObject::invokeMethod(this, [this, foreignPackages, snapshotKey, dependencyGraph, generation] {
+        finishLoading(foreignPackages, snapshotKey, dependencyGraph, generation);
+    }, Qt::QueuedConnection);
 }
 
 // Load installed (local) packages
-void PackagesModel::loadLocalDatabase()
+QVector<Package *> PackagesModel::loadLocalDatabase(alpm_handle_t *handle)
 {
     emit databaseLoadingMessageChanged("Loading installed packages");
 
-    alpm_db_t *database = alpm_get_localdb(m_handle);
+    QVector<Package *> installedPackages;
+    alpm_db_t *database = alpm_get_localdb(handle);
     alpm_list_t *cache = alpm_db_get_pkgcache(database);
     while (cache != nullptr) {
         if (m_loadingDatabases.isCanceled())
-            return;
+            return installedPackages;
 
         auto *packageData = static_cast<alpm_pkg_t *>(cache->data);
         auto *package = new Package;
         package->setLocalData(packageData);
+        installedPackages.append(package);
 
-        beginInsertRows(QModelIndex(), m_repoPackages.size(), m_repoPackages.size());
-        m_repoPackages.append(package);
-        m_installedPackages.append(package);
+        cache = cache->next;
+    }
 
-        // Emit signal about first package
-        if (m_repoPackages.size() == 1)
-            emit firstPackageAvailable();
+    return installedPackages;
+}
 
-        cache = cache->next;
+// Read sync databases and merge them in pacman.conf order to keep repositories precedence
+QVector<Package *> PackagesModel::loadSyncDatabases(const PacmanSettings &settings, const QVector<Package *> &installedPackages)
+{
+    emit databaseLoadingMessageChanged("Loading sync databases");
+
+    // Handle is not thread-safe, so every database is read with its own one
+    const QByteArray rootDir = settings.rootDir().toLocal8Bit();
+    const QByteArray databasesPath = settings.databasesPath().toLocal8Bit();
+    QVector<SyncDatabase> databases;
+    foreach (const QString &databaseName, settings.repositories())
+        databases.append({databaseName.toLocal8Bit(), nullptr, {}});
+
+    QtConcurrent::blockingMap(databases, [&rootDir, &databasesPath](SyncDatabase &database) {
+        alpm_errno_t error = ALPM_ERR_OK;
+        database.handle = alpm_initialize(rootDir.constData(), databasesPath.constData(), &error);
+        if (error != ALPM_ERR_OK) {
+            qDebug() << alpm_strerror(error);
+            return;
+        }
+
+        alpm_db_t *syncDatabase = alpm_register_syncdb(database.handle, database.name.constData(), 0);
+        if (syncDatabase != nullptr)
+            database.packages = syncDatabasePackages(syncDatabase);
+    });
+
+    QVector<QVector<alpm_pkg_t *>> batches;
+    for (const SyncDatabase &database : qAsConst(databases)) {
+        if (database.handle != nullptr) {
+            m_handles.append(database.handle);
+            batches.append(database.packages);
+        }
     }
-    endInsertRows();
+
+    QHash<QString, Package *> installedPackagesIndex;
+    installedPackagesIndex.reserve(installedPackages.size());
+    for (Package *package : installedPackages)
+        installedPackagesIndex.insert(package->name(), package);
+
+    // Installed package takes sync data from the first repository that contains it
+    QVector<Package *> syncPackages;
+    QSet<Package *> syncedPackages;
+    for (const QVector<alpm_pkg_t *> &batch : batches) {
+        for (alpm_pkg_t *packageData : batch) {
+            if (m_loadingDatabases.isCanceled())
+                return syncPackages;
+
+            // Check if package installed
+            Package *installedPackage = installedPackagesIndex.value(alpm_pkg_get_name(packageData));
+            if (installedPackage != nullptr) {
+                if (syncedPackages.contains(installedPackage))
+                    continue;
+
+                installedPackage->setSyncData(packageData);
+                syncedPackages.insert(installedPackage);
+            } else {
+                // Add new sync package to database
+                auto *package = new Package;
+                package->setSyncData(packageData);
+                syncPackages.append(package);
+            }
+        }
+    }
+
+    return syncPackages;
 }
 
-void PackagesModel::loadSyncDatabase(const QString &databaseName)
+// Check if updates for local packages is available from sync and aur databases
+void PackagesModel::checkForUpdates(const PacmanSettings &settings)
 {
-    emit databaseLoadingMessageChanged("Loading " + databaseName + " database");
+    emit databaseLoadingMessageChanged("Checking for updates");
 
-    alpm_db_t *database = alpm_register_syncdb(m_handle, qPrintable(databaseName), 0);
-    if (database == nullptr)
-        return;
+    m_outdatedPackages.clear();
+    const QStringList ignoredPackages = settings.ignoredPackages();
+    foreach (Package *package, m_installedPackages) {
+        if (!package->availableUpdate().isEmpty() && !ignoredPackages.contains(package->name()))
+            m_outdatedPackages.append(package);
+    }
+
+    if (m_outdatedPackages.empty())
+        setDatabaseStatus(NoUpdates);
+    else
+        setDatabaseStatus(UpdatesAvailable);
+}
 
+QVector<alpm_pkg_t *> PackagesModel::syncDatabasePackages(alpm_db_t *database)
+{
+    QVector<alpm_pkg_t *> packages;
     alpm_list_t *cache = alpm_db_get_pkgcache(database);
     while (cache != nullptr) {
-        if (m_loadingDatabases.isCanceled())
+        packages.append(static_cast<alpm_pkg_t *>(cache->data));
+        cache = cache->next;
+    }
+
+    return packages;
+}
+
+// Decode fields used by the list once, packages will read them from the table
+void PackagesModel::fillPackagesTable(const QVector<Package *> &packages)
+{
+    QSharedPointer<PackagesTable> table(new PackagesTable);
+    table->reserve(packages.size());
+    for (Package *package : packages)
+        package->setTableRow(table, table->append(*package));
+}
+
+// Pass packages to the GUI thread by chunks to insert them with a single notification per chunk
+void PackagesModel::postPackages(const QVector<Package *> &packages)
+{
+    // Packages that will be merged into displayed ones should be passed at once
+    const int chunkSize = m_mergeLoadedPackages ? packages.size() : PACKAGES_CHUNK_SIZE;
+    for (int i = 0; i < packages.size(); i += chunkSize) {
+        QMutexLocker locker(&m_pendingPackagesMutex);
+        m_pendingPackages.enqueue(packages.mid(i, chunkSize));
+        QMetaObject::invokeMethod(this, &PackagesModel::insertPendingPackages, Qt::QueuedConnection);
+    }
+}
+
+void PackagesModel::insertPendingPackages()
+{
+    QVector<Package *> packages;
+    {
+        QMutexLocker locker(&m_pendingPackagesMutex);
+        if (m_pendingPackages.isEmpty())
             return;
+        packages = m_pendingPackages.dequeue();
+    }
 
-        auto *packageData = static_cast<alpm_pkg_t *>(cache->data);
+    if (m_mergeLoadedPackages) {
+        mergePackages(packages);
+        return;
+    }
+
+    indexInstalledPackages(packages);
+    appendPackages(packages);
+
+    // Emit signal about first package
+    if (m_mode == Repo && m_repoPackages.size() == packages.size())
+        emit firstPackageAvailable();
+}
+
+// Add packages to the end, only packages matching the filter become visible when it is set
+void PackagesModel::appendPackages(const QVector<Package *> &packages)
+{
+    // Rows are not displayed in AUR mode
+    const bool rowsDisplayed = m_mode == Repo;
+
+    // Orphans and files filters are updated after loading, files are not known from packages
+    QVector<Package *> displayedPackages;
+    if (!m_filtered) {
+        displayedPackages = packages;
+    } else if (!m_orphansFiltered && m_fileFilter.isEmpty()) {
+        foreach (Package *package, packages) {
+            if (containsTerms(*package, m_filterTerms, m_filterFields))
+                displayedPackages.append(package);
+        }
+    }
+
+    if (rowsDisplayed && !displayedPackages.isEmpty())
+        beginInsertRows(QModelIndex(), rowCount(), rowCount() + displayedPackages.size() - 1);
+
+    const int firstPosition = m_repoPackages.size();
+    m_repoPackages.append(packages);
+    updatePositions(firstPosition);
+    indexPackageNames(packages);
+    if (m_filtered)
+        m_filteredPackages.append(displayedPackages);
+
+    if (rowsDisplayed && !displayedPackages.isEmpty())
+        endInsertRows();
+}
+
+// Remove rows of the packages, adjacent rows are removed at once
+void PackagesModel::removePackages(QVector<Package *> &packages, const QSet<Package *> &removedPackages, bool notify)
+{
+    for (int i = packages.size() - 1; i >= 0; --i) {
+        if (!removedPackages.contains(packages.at(i)))
+            continue;
+
+        const int lastRow = i;
+        while (i > 0 && removedPackages.contains(packages.at(i - 1)))
+            --i;
+
+        if (notify)
+            beginRemoveRows(QModelIndex(), i, lastRow);
+        packages.remove(i, lastRow - i + 1);
+        if (notify)
+            endRemoveRows();
+    }
+}
+
+void PackagesModel::updatePositions(int from)
+{
+    if (from == 0)
+        m_repoPackagesPositions.clear();
+
+    m_repoPackagesPositions.reserve(m_repoPackages.size());
+    for (int i = from; i < m_repoPackages.size(); ++i)
+        m_repoPackagesPositions.insert(m_repoPackages.at(i), i);
+}
+
+void PackagesModel::sortByPositions(QVector<Package *> &packages) const
+{
+    std::sort(packages.begin(), packages.end(), [this](const Package *first, const Package *second) {
+        return m_repoPackagesPositions.value(first) < m_repoPackagesPositions.value(second);
+    });
+}
+
+// Filtered packages are in the same order as all packages, so the row can be found by binary search
+int PackagesModel::displayedRow(const Package *package) const
+{
+    const int position = m_repoPackagesPositions.value(package, -1);
+    if (!m_filtered || position == -1)
+        return position;
 
-        // Check if package installed
-        bool found = false;
-        for (Package *package : m_repoPackages) {
-            if (!package->isInstalled() || !package->sameName(packageData))
-                continue;
+    const auto it = std::lower_bound(m_filteredPackages.cbegin(), m_filteredPackages.cend(), position, [this](const Package *filteredPackage, int position) {
+        return m_repoPackagesPositions.value(filteredPackage) < position;
+    });
+    if (it == m_filteredPackages.cend() || *it != package)
+        return -1;
+
+    return static_cast<int>(it - m_filteredPackages.cbegin());
+}
+
+const QVector<Package *> &PackagesModel::displayedPackages() const
+{
+    return m_filtered ? m_filteredPackages : m_repoPackages;
+}
+
+bool PackagesModel::containsTerms(const Package &package, const QStringList &terms, PackagesIndex::Fields fields)
+{
+    return std::all_of(terms.cbegin(), terms.cend(), [&package, fields](const QString &term) {
+        return (fields.testFlag(PackagesIndex::Name) && package.name().contains(term))
+                || (fields.testFlag(PackagesIndex::Description) && package.description().contains(term))
+                || (fields.testFlag(PackagesIndex::Maintainer) && package.maintainer().contains(term));
+    });
+}
+
+void PackagesModel::indexInstalledPackages(const QVector<Package *> &packages)
+{
+    for (Package *package : packages) {
+        if (!package->isInstalled())
+            continue;
 
-            package->setSyncData(packageData);
+        m_installedPackages.append(package);
+        m_installedPackagesIndex.insert(package->name(), package);
+    }
+}
+
+// The first package with a name is kept, like the first search result in the repositories order
+void PackagesModel::indexPackageNames(const QVector<Package *> &packages)
+{
+    for (Package *package : packages) {
+        if (!m_repoPackagesIndex.contains(package->name()))
+            m_repoPackagesIndex.insert(package->name(), package);
+
+        foreach (const Depend &provide, package->provides())
+            m_providersIndex[provide.name()].append(package);
+    }
+}
+
+// Rebind displayed packages to loaded data instead of model reset to keep selection, scroll position and filter
+void PackagesModel::mergePackages(const QVector<Package *> &packages)
+{
+    QMultiHash<QString, int> loadedPackages;
+    loadedPackages.reserve(packages.size());
+    for (int i = 0; i < packages.size(); ++i)
+        loadedPackages.insert(packages.at(i)->name(), i);
+
+    // Update existing packages
+    QVector<bool> merged(packages.size(), false);
+    QSet<Package *> removedPackages;
+    int firstChangedRow = rowCount();
+    int lastChangedRow = -1;
+    for (Package *package : qAsConst(m_repoPackages)) {
+        const int loadedIndex = takeLoadedPackage(loadedPackages, packages, *package);
+        if (loadedIndex == -1) {
+            removedPackages.insert(package);
+            continue;
+        }
+
+        const Package *loadedPackage = packages.at(loadedIndex);
+        const bool changed = package->version() != loadedPackage->version()
+                || package->installDate() != loadedPackage->installDate()
+                || package->isInstalled() != loadedPackage->isInstalled()
+                || package->isInstalledExplicitly() != loadedPackage->isInstalledExplicitly();
+
+        *package = *loadedPackage;
+        delete loadedPackage;
+        merged[loadedIndex] = true;
+
+        if (changed) {
+            const int row = displayedRow(package);
+            if (row != -1) {
+                firstChangedRow = qMin(firstChangedRow, row);
+                lastChangedRow = qMax(lastChangedRow, row);
+            }
             emit packageChanged(package);
-            found = true;
-            break;
         }
+    }
+
+    // Rows are not displayed in AUR mode
+    const bool rowsDisplayed = m_mode == Repo;
+    if (rowsDisplayed && lastChangedRow != -1)
+        emit dataChanged(index(firstChangedRow, 0), index(lastChangedRow, columnCount() - 1));
+
+    // Remove packages that no longer exist
+    if (!removedPackages.isEmpty()) {
+        // Hidden rows are not removed from the view, so packages are reported separately before deletion
+        emit packagesRemoved(removedPackages);
+        if (m_filtered)
+            removePackages(m_filteredPackages, removedPackages, rowsDisplayed);
+        removePackages(m_repoPackages, removedPackages, rowsDisplayed && !m_filtered);
+        qDeleteAll(removedPackages);
+        updatePositions(0);
+    }
+
+    // Provides of rebound packages could change
+    m_repoPackagesIndex.clear();
+    m_providersIndex.clear();
+    indexPackageNames(m_repoPackages);
 
-        // Add new sync package to database
-        if (!found) {
-            auto *package = new Package;
-            package->setSyncData(packageData);
+    // Append new packages
+    QVector<Package *> newPackages;
+    for (int i = 0; i < packages.size(); ++i) {
+        if (!merged.at(i))
+            newPackages.append(packages.at(i));
+    }
+    appendPackages(newPackages);
 
-            beginInsertRows(QModelIndex(), m_repoPackages.size(), m_repoPackages.size());
-            m_repoPackages.append(package);
+    m_installedPackages.clear();
+    m_installedPackagesIndex.clear();
+    m_outdatedPackages.clear();
+    indexInstalledPackages(m_repoPackages);
+
+    // Index will be rebuilt after loading
+    m_searchIndex.reset();
+    m_indexedPackages.clear();
+
+    // No packages use the previous handle anymore
+    rebindAurPackages();
+    releaseHandles(m_previousHandles);
+    m_mergeLoadedPackages = false;
+}
+
+// AUR results contain copies of installed packages, which refer to the previous handle
+void PackagesModel::rebindAurPackages()
+{
+    const bool rowsDisplayed = m_mode == AUR;
+    QSet<Package *> removedPackages;
+    for (int row = 0; row < m_aurPackages.size(); ++row) {
+        Package *package = m_aurPackages.at(row);
+        if (!package->isInstalled())
+            continue;
+
+        // Local data of uninstalled package is not available anymore
+        const Package *installedPackage = m_installedPackagesIndex.value(package->name());
+        if (installedPackage == nullptr) {
+            removedPackages.insert(package);
+            continue;
         }
 
-        cache = cache->next;
+        *package = *installedPackage;
+        if (rowsDisplayed)
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+        emit packageChanged(package);
+    }
+
+    if (!removedPackages.isEmpty()) {
+        emit packagesRemoved(removedPackages);
+        removePackages(m_aurPackages, removedPackages, rowsDisplayed);
+        qDeleteAll(removedPackages);
+    }
+}
+
+// Find loaded package with the same name, preferring the same repository
+int PackagesModel::takeLoadedPackage(QMultiHash<QString, int> &loadedPackages, const QVector<Package *> &packages, const Package &package)
+{
+    const QString name = package.name();
+    const QString repo = package.repo();
+    auto match = loadedPackages.end();
+    for (auto it = loadedPackages.find(name); it != loadedPackages.end() && it.key() == name; ++it) {
+        if (match == loadedPackages.end())
+            match = it;
+
+        if (packages.at(it.value())->repo() == repo) {
+            match = it;
+            break;
+        }
     }
-    endInsertRows();
+
+    if (match == loadedPackages.end())
+        return -1;
+
+    const int loadedIndex = match.value();
+    loadedPackages.erase(match);
+    return loadedIndex;
 }
 
-void PackagesModel::loadAurDatabase()
+// Request AUR info for foreign packages after all packages were inserted
+void PackagesModel::finishLoading(const QStringList &foreignPackages, const QByteArray &snapshotKey, const QSharedPointer<const DependencyGraph> &dependencyGraph, int generation)
 {
+    // Databases were reloaded again while this call was queued
+    if (generation != m_loadingGeneration)
+        return;
+
+    m_snapshotKey = snapshotKey;
+    m_dependencyGraph = dependencyGraph;
+    if (m_orphansFiltered)
+        setOrphansFilter(m_filterTerms, m_optdependsRequired);
+
+    // Files index is checked for changes on the next search by files
+    m_fileOwnersIndex.reset();
+    if (!m_fileFilter.isEmpty())
+        setFileFilter(m_fileFilter);
+
+    if (foreignPackages.isEmpty()) {
+        processForeignPackagesInfo(QJsonArray());
+        return;
+    }
+
     emit databaseLoadingMessageChanged("Loading information from AUR");
-    QNetworkAccessManager manager;
-    QUrl url(AUR_API_URL);
+    m_aurClient->loadInfo(foreignPackages);
+}
 
-    // Get local packages names for query
-    QString query = QStringLiteral("v=5&type=info");
-    foreach (Package *package, m_repoPackages) {
-        if (package->isInstalled() && package->repo() == "local")
-            query.append("&arg[]=" + package->name());
+// Apply AUR info, check for updates and save snapshot
+void PackagesModel::processForeignPackagesInfo(const QJsonArray &aurPackages)
+{
+    foreach (const QJsonValue &packageData, aurPackages) {
+        Package *package = m_installedPackagesIndex.value(packageData["Name"].toString());
+        if (package != nullptr)
+            package->setAurData(packageData.toObject(), true);
     }
-    url.setQuery(query);
+    if (!aurPackages.isEmpty() && m_mode == Repo && rowCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
 
-    // Make API request
-    QScopedPointer reply(manager.get(QNetworkRequest(url)));
-    QEventLoop waitForReply;
-    connect(reply.get(), &QNetworkReply::finished, &waitForReply, &QEventLoop::quit);
-    waitForReply.exec();
+    const PacmanSettings settings;
+    checkForUpdates(settings);
+    buildSearchIndex();
+    PackagesSnapshot::save(m_repoPackages, m_snapshotKey);
 
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << reply->errorString();
-        return;
+    emit databaseLoadingMessageChanged(QString::number(m_repoPackages.size())
+                               + " packages avaible in official repositories, "
+                               + QString::number(m_installedPackages.size())
+                               + " packages installed, "
+                               + (m_outdatedPackages.empty() ? "no" : QString::number(m_outdatedPackages.size()))
+                               + " updates available");
+}
+
+void PackagesModel::processAurSearch(const QJsonArray &aurPackages)
+{
+    // Search could finish after switching to repo mode
+    const bool rowsDisplayed = m_mode == AUR;
+    if (rowsDisplayed)
+        beginResetModel();
+
+    // Clear old data
+    qDeleteAll(m_aurPackages);
+    m_aurPackages.clear();
+
+    foreach (const QJsonValue &aurPackageData, aurPackages) {
+        // Use local data for installed package
+        const Package *installedPackage = m_installedPackagesIndex.value(aurPackageData["Name"].toString());
+        if (installedPackage != nullptr) {
+            m_aurPackages.append(new Package(*installedPackage));
+            continue;
+        }
+
+        // Create new package
+        auto *package = new Package;
+        package->setAurData(aurPackageData.toObject());
+        m_aurPackages.append(package);
     }
 
-    // Parse data and info for packages
-    const QJsonObject jsonReply = QJsonDocument::fromJson(reply->readAll()).object();
-    foreach (QJsonValue packageData, jsonReply.value("results").toArray()) {
-        for (Package *package : m_repoPackages) {
-            if (package->isInstalled() && package->name() == packageData["Name"].toString())
-                package->setAurData(packageData.toObject(), true);
+    if (rowsDisplayed)
+        endResetModel();
+
+    emit searchFinished(m_searchTimer.elapsed());
+}
+
+void PackagesModel::processAurDetails(const QJsonObject &packageData)
+{
+    // Search results could be replaced while details were loading, so find the package by name
+    const QString packageName = packageData.value("Name").toString();
+    foreach (Package *package, m_aurPackages) {
+        if (package->name() == packageName) {
+            package->setAurData(packageData, true);
+            emit packageChanged(package);
+            return;
         }
     }
 }
 
-// Check if updates for local packages is available from sync and aur databases
-void PackagesModel::checkForUpdates(const PacmanSettings &settings)
+// Index is rebuilt only if databases were changed since the last build
+void PackagesModel::loadFileOwnersIndex()
 {
-    emit databaseLoadingMessageChanged("Checking for updates");
+    if (m_fileOwnersIndexLoading)
+        return;
 
-    const QStringList ignoredPackages = settings.ignoredPackages();
-    foreach (Package *package, m_repoPackages) {
-        if (!package->availableUpdate().isEmpty() && !ignoredPackages.contains(package->name()))
-            m_outdatedPackages.append(package);
+    emit databaseLoadingMessageChanged("Loading files index");
+    m_fileOwnersIndexLoading = true;
+    const int generation = m_loadingGeneration;
+    m_loadingFileOwnersIndex = QtConcurrent::run([this, generation] {
+        const PacmanSettings settings;
+        const QString fileName = FileOwnersIndex::defaultFileName();
+        const QByteArray key = FileOwnersIndex::databasesKey(settings);
+        QSharedPointer<FileOwnersIndex> fileOwnersIndex(new FileOwnersIndex);
+        if (!fileOwnersIndex->open(fileName, key)) {
+            fileOwnersIndex.reset(new FileOwnersIndex);
+            if (!FileOwnersIndex::build(fileName, key, settings) || !fileOwnersIndex->open(fileName, key))
+                fileOwnersIndex.reset();
+        }
+
+        QMetaObject::invokeMethod(this, [this, fileOwnersIndex, generation] {
+            m_fileOwnersIndexLoading = false;
+
+            // Databases could be changed while building
+            if (generation != m_loadingGeneration) {
+                if (m_filterPending && m_pendingFileFilter)
+                    loadFileOwnersIndex();
+                return;
+            }
+
+            if (fileOwnersIndex == nullptr) {
+                if (m_pendingFileFilter)
+                    m_filterPending = false;
+                emit databaseLoadingMessageChanged("Unable to load files index");
+                return;
+            }
+
+            m_fileOwnersIndex = fileOwnersIndex;
+            emit databaseLoadingMessageChanged("Files index loaded");
+            if (m_filterPending && !m_filtering.isRunning())
+                startFiltering();
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Strings are taken here because packages belong to the GUI thread, trigrams are collected in background
+// Only one build runs at a time, so the destructor waits for it, and the latest packages are indexed after it
+void PackagesModel::buildSearchIndex()
+{
+    if (m_buildingSearchIndex.isRunning()) {
+        m_searchIndexPending = true;
+        return;
     }
+    m_searchIndexPending = false;
+
+    QSharedPointer<PackagesIndex> searchIndex(new PackagesIndex);
+    searchIndex->reserve(m_repoPackages.size());
+    foreach (const Package *package, m_repoPackages)
+        searchIndex->append(package->name(), package->description(), package->maintainer());
+
+    const QVector<Package *> packages = m_repoPackages;
+    const int generation = m_loadingGeneration;
+    m_buildingSearchIndex = QtConcurrent::run([this, searchIndex, packages, generation] {
+        searchIndex->build();
+        QMetaObject::invokeMethod(this, [this, searchIndex, packages, generation] {
+            if (m_searchIndexPending) {
+                buildSearchIndex();
+                return;
+            }
+            if (generation != m_loadingGeneration)
+                return;
 
-    if (m_outdatedPackages.empty())
-        setDatabaseStatus(NoUpdates);
-    else
-        setDatabaseStatus(UpdatesAvailable);
+            m_searchIndex = searchIndex;
+            m_indexedPackages = packages;
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Display packages from the previous launch while databases are loading
+void PackagesModel::loadSnapshot()
+{
+    const PacmanSettings settings;
+    m_repoPackages = PackagesSnapshot::load(PackagesSnapshot::databasesKey(settings));
+    m_mergeLoadedPackages = !m_repoPackages.isEmpty();
+    updatePositions(0);
+    indexPackageNames(m_repoPackages);
+}
+
+// Drop chunks of previous loading that were not inserted yet
+void PackagesModel::dropPendingPackages()
+{
+    QMutexLocker locker(&m_pendingPackagesMutex);
+    foreach (const QVector<Package *> &chunk, m_pendingPackages)
+        qDeleteAll(chunk);
+    m_pendingPackages.clear();
 }
 
 void PackagesModel::resetDatabase()
@@ -505,13 +1265,40 @@ void PackagesModel::resetDatabase()
 
     qDeleteAll(m_repoPackages);
     m_repoPackages.clear();
+    m_repoPackagesPositions.clear();
+    m_filteredPackages.clear();
     m_outdatedPackages.clear();
     m_installedPackages.clear();
-    alpm_release(m_handle);
+    m_installedPackagesIndex.clear();
+    m_repoPackagesIndex.clear();
+    m_providersIndex.clear();
+    m_searchIndex.reset();
+    m_indexedPackages.clear();
+    m_mergeLoadedPackages = false;
+    dropPendingPackages();
+
+    // Copies of installed packages in AUR results refer to the released handle
+    QSet<Package *> installedAurPackages;
+    foreach (Package *package, m_aurPackages) {
+        if (package->isInstalled())
+            installedAurPackages.insert(package);
+    }
+    removePackages(m_aurPackages, installedAurPackages, false);
+    qDeleteAll(installedAurPackages);
+
+    releaseHandles(m_handles);
+    releaseHandles(m_previousHandles);
 
     endResetModel();
 }
 
+void PackagesModel::releaseHandles(QVector<alpm_handle_t *> &handles)
+{
+    for (alpm_handle_t *handle : qAsConst(handles))
+        alpm_release(handle);
+    handles.clear();
+}
+
 void PackagesModel::setDatabaseStatus(DatabaseStatus databaseStatus)
 {
     if (m_databaseStatus == databaseStatus)
@@ -521,41 +1308,44 @@ void PackagesModel::setDatabaseStatus(DatabaseStatus databaseStatus)
     emit databaseStatusChanged(m_databaseStatus);
 }
 
-template<typename T1, typename T2>
-void PackagesModel::sortPackages(QVector<Package *> &container, Qt::SortOrder order, T1 firstMember, T2 secondMember)
-{
-//    map
-    switch (order) {
-    case Qt::AscendingOrder:
-        std::sort(std::execution::par_unseq, container.begin(), container.end(), [&](Package *first, Package *second) {
-            if ((first->*firstMember)() == (second->*firstMember)())
-                return (first->*secondMember)() < (second->*secondMember)();
-            return (first->*firstMember)() > (second->*firstMember)();
-        });
-        break;
-    case Qt::DescendingOrder:
-        std::sort(std::execution::par_unseq, container.begin(), container.end(), [&](Package *first, Package *second) {
-            if ((first->*firstMember)() == (second->*firstMember)())
-                return (first->*secondMember)() < (second->*secondMember)();
-            return (first->*firstMember)() < (second->*firstMember)();
-        });
-        break;
-    }
-}
-
+// Sort by the member with name as a second key
 template<typename T>
 void PackagesModel::sortPackages(QVector<Package *> &container, Qt::SortOrder order, T member)
 {
+    // Extract keys once to avoid calling getters on each comparison
+    using Key = decltype((std::declval<const Package &>().*member)());
+    QVector<Key> keys;
+    QVector<QString> names;
+    keys.reserve(container.size());
+    names.reserve(container.size());
+    for (const Package *package : container) {
+        keys.append((package->*member)());
+        names.append(package->name());
+    }
+
+    // Sort positions instead of packages
+    QVector<int> positions(container.size());
+    std::iota(positions.begin(), positions.end(), 0);
     switch (order) {
     case Qt::AscendingOrder:
-        std::sort(std::execution::par_unseq, container.begin(), container.end(), [&](Package *first, Package *second) {
-            return (first->*member)() > (second->*member)();
+        std::sort(std::execution::par_unseq, positions.begin(), positions.end(), [&](int first, int second) {
+            if (keys.at(first) == keys.at(second))
+                return names.at(first) < names.at(second);
+            return keys.at(first) > keys.at(second);
         });
         break;
     case Qt::DescendingOrder:
-        std::sort(std::execution::par_unseq, container.begin(), container.end(), [&](Package *first, Package *second) {
-            return (first->*member)() < (second->*member)();
+        std::sort(std::execution::par_unseq, positions.begin(), positions.end(), [&](int first, int second) {
+            if (keys.at(first) == keys.at(second))
+                return names.at(first) < names.at(second);
+            return keys.at(first) < keys.at(second);
         });
         break;
     }
+
+    QVector<Package *> sortedContainer;
+    sortedContainer.reserve(container.size());
+    for (int position : positions)
+        sortedContainer.append(container.at(position));
+    container = sortedContainer;
 }
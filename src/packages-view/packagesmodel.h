@@ -1,13 +1,22 @@
 #ifndef PACKAGESMODEL_H
 #define PACKAGESMODEL_H
 
+#include "packagesindex.h"
+
 #include <QAbstractItemModel>
+#include <QElapsedTimer>
 #include <QtConcurrent>
+#include <QMutex>
+#include <QQueue>
 
 #include <alpm.h>
 
 class Package;
-class QNetworkAccessManager;
+class AurClient;
+class FileOwnersIndex;
+class DependencyGraph;
+class QJsonArray;
+class QJsonObject;
 class PacmanSettings;
 
 class PackagesModel : public QAbstractItemModel
@@ -25,6 +34,10 @@ public:
         UpdatesAvailable,
         NoUpdates
     };
+    enum ReloadMode {
+        FullReload,
+        DeltaReload
+    };
 
     explicit PackagesModel(QObject *parent = nullptr);
     ~PackagesModel() override;
@@ -46,49 +59,139 @@ public:
     DatabaseStatus databaseStatus() const;
     QVector<Package *> packages() const;
     QVector<Package *> outdatedPackages() const;
-    void reloadRepoPackages();
+    QVector<Package *> installedPackages() const;
+    void setFilter(const QStringList &terms, PackagesIndex::Fields fields);
+    void setFileFilter(const QString &path);
+    void setOrphansFilter(const QStringList &terms, bool optdependsRequired);
+    QVector<Package *> orphans(bool optdependsRequired) const;
+    void calculateRemovalImpact(const QStringList &uninstall, const QStringList &uninstallWithUnused);
+    Package *findPackage(const QString &packageName) const;
+    QVector<Package *> findProviders(const QString &packageName) const;
+    QModelIndex packageIndex(const Package *package, int column = 0) const;
+    QStringList requiredBy(const QString &packageName) const;
+    QStringList optionalFor(const QString &packageName) const;
+    void reloadRepoPackages(ReloadMode reloadMode = FullReload);
     void aurQuery(const QString &text, const QString &searchType);
     void loadMoreAurInfo(Package *package);
+    void setOfflineAurSearch(bool enabled, const QString &archiveFile);
 
 signals:
     void databaseStatusChanged(PackagesModel::DatabaseStatus status);
     void databaseLoadingMessageChanged(const QString &text);
     void firstPackageAvailable();
     void packageChanged(Package *package);
+    void packagesRemoved(const QSet<Package *> &packages);
+    void searchFinished(qint64 elapsed);
+    void removalImpactCalculated(qint64 targetsSize, qint64 unusedSize, const QStringList &unusedPackages);
 
 private:
     void setDatabaseStatus(DatabaseStatus databaseStatus);
-    void loadDatabases();
+    void loadDatabases(int generation);
 
     // Helper functions for loading all types of databases
-    void loadLocalDatabase();
-    void loadSyncDatabase(const QString &databaseName);
-    void loadAurDatabase();
+    QVector<Package *> loadLocalDatabase(alpm_handle_t *handle);
+    QVector<Package *> loadSyncDatabases(const PacmanSettings &settings, const QVector<Package *> &installedPackages);
+    static QVector<alpm_pkg_t *> syncDatabasePackages(alpm_db_t *database);
 
     void checkForUpdates(const PacmanSettings &settings);
+    static void fillPackagesTable(const QVector<Package *> &packages);
+    void postPackages(const QVector<Package *> &packages);
+    void insertPendingPackages();
+    void appendPackages(const QVector<Package *> &packages);
+    void removePackages(QVector<Package *> &packages, const QSet<Package *> &removedPackages, bool notify);
+    void indexInstalledPackages(const QVector<Package *> &packages);
+    void indexPackageNames(const QVector<Package *> &packages);
+    void mergePackages(const QVector<Package *> &packages);
+    void rebindAurPackages();
+    static int takeLoadedPackage(QMultiHash<QString, int> &loadedPackages, const QVector<Package *> &packages, const Package &package);
+    void finishLoading(const QStringList &foreignPackages, const QByteArray &snapshotKey, const QSharedPointer<const DependencyGraph> &dependencyGraph, int generation);
+
+    // AUR requests results
+    void processForeignPackagesInfo(const QJsonArray &aurPackages);
+    void processAurSearch(const QJsonArray &aurPackages);
+    void processAurDetails(const QJsonObject &packageData);
+    void buildSearchIndex();
+    void loadFileOwnersIndex();
+
+    // Filtering
+    void startFiltering();
+    void applyFilter(const QStringList &terms, PackagesIndex::Fields fields, QVector<Package *> packages);
+    QVector<Package *> findPackages(const QStringList &terms, PackagesIndex::Fields fields) const;
+    static bool containsTerms(const Package &package, const QStringList &terms, PackagesIndex::Fields fields);
+    void updatePositions(int from);
+    void sortByPositions(QVector<Package *> &packages) const;
+    int displayedRow(const Package *package) const;
+    const QVector<Package *> &displayedPackages() const;
+    void loadSnapshot();
+    void dropPendingPackages();
     void resetDatabase();
+    static void releaseHandles(QVector<alpm_handle_t *> &handles);
 
     // Sorting
-    template<typename T1, typename T2>
-    void sortPackages(QVector<Package *> &container, Qt::SortOrder order, T1 firstMember, T2 secondMember);
-
     template<typename T>
     void sortPackages(QVector<Package *> &container, Qt::SortOrder order, T member);
 
     // ALPM stuff
-    alpm_handle_t *m_handle = nullptr;
+    // Local database handle goes first, followed by one handle per sync database
+    QVector<alpm_handle_t *> m_handles;
+    QVector<alpm_handle_t *> m_previousHandles;
     alpm_errno_t m_error = ALPM_ERR_OK;
 
     Mode m_mode = Repo;
     DatabaseStatus m_databaseStatus = Loading;
     QFuture<void> m_loadingDatabases;
+    int m_loadingGeneration = 0;
 
     QVector<Package *> m_repoPackages;
     QVector<Package *> m_aurPackages;
     QVector<Package *> m_installedPackages;
     QVector<Package *> m_outdatedPackages;
-
-    QNetworkAccessManager *m_manager;
+    QHash<QString, Package *> m_installedPackagesIndex;
+
+    // Dependency lookup by package name and by provided name
+    QHash<QString, Package *> m_repoPackagesIndex;
+    QHash<QString, QVector<Package *>> m_providersIndex;
+
+    // Packages matching the filter in the order of all packages
+    QVector<Package *> m_filteredPackages;
+    QHash<const Package *, int> m_repoPackagesPositions;
+    QStringList m_filterTerms;
+    PackagesIndex::Fields m_filterFields;
+    bool m_filtered = false;
+    bool m_orphansFiltered = false;
+    bool m_optdependsRequired = true;
+    QString m_fileFilter;
+
+    // Queries are processed in background one at a time, only the latest one is applied
+    QFuture<void> m_filtering;
+    QStringList m_pendingFilterTerms;
+    PackagesIndex::Fields m_pendingFilterFields;
+    bool m_filterPending = false;
+    bool m_pendingFileFilter = false;
+    int m_filterGeneration = 0;
+    QElapsedTimer m_searchTimer;
+
+    // Loaded packages waiting to be inserted from the GUI thread
+    QQueue<QVector<Package *>> m_pendingPackages;
+    QMutex m_pendingPackagesMutex;
+    bool m_mergeLoadedPackages = false;
+
+    // Search index refers to packages by position in the vector of indexed packages
+    QSharedPointer<const PackagesIndex> m_searchIndex;
+    QVector<Package *> m_indexedPackages;
+    QFuture<void> m_buildingSearchIndex;
+    bool m_searchIndexPending = false;
+
+    // Packages that own files, loaded on the first search by files
+    QSharedPointer<const FileOwnersIndex> m_fileOwnersIndex;
+    QFuture<void> m_loadingFileOwnersIndex;
+    bool m_fileOwnersIndexLoading = false;
+
+    QSharedPointer<const DependencyGraph> m_dependencyGraph;
+    QFuture<void> m_calculatingRemoval;
+    int m_removalGeneration = 0;
+    QByteArray m_snapshotKey;
+    AurClient *m_aurClient;
 };
 
 Q_DECLARE_METATYPE(PackagesModel::DatabaseStatus)
@@ -0,0 +1,101 @@
+#include "packagessnapshot.h"
+#include "package.h"
+#include "../pacmansettings.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QDebug>
+
+constexpr quint32 SNAPSHOT_MAGIC = 0x4F52534E; // "ORSN"
+constexpr quint32 SNAPSHOT_VERSION = 1;
+
+// Modification times of databases, snapshot is valid only while they are the same
+QByteArray PackagesSnapshot::databasesKey(const PacmanSettings &settings)
+{
+    const QDir databasesDir(settings.databasesPath());
+    QByteArray key = settings.repositories().join(',').toUtf8();
+
+    // Called from the GUI thread, so only the local database directory is checked, it changes on install and removal.
+    // Reason updates only rewrite descriptions, loaded packages fix them when merged into the snapshot.
+    const QFileInfo localDir(databasesDir.filePath("local"));
+    const QFileInfo localVersion(databasesDir.filePath("local/ALPM_DB_VERSION"));
+    key += ";local:" + QByteArray::number(localDir.lastModified().toMSecsSinceEpoch())
+            + ':' + QByteArray::number(localVersion.lastModified().toMSecsSinceEpoch());
+
+    const QDir syncDir(databasesDir.filePath("sync"));
+    foreach (const QFileInfo &database, syncDir.entryInfoList({"*.db"}, QDir::Files, QDir::Name))
+        key += ';' + database.fileName().toUtf8() + ':' + QByteArray::number(database.lastModified().toMSecsSinceEpoch());
+
+    return key;
+}
+
+QVector<Package *> PackagesSnapshot::load(const QByteArray &key)
+{
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    // Read snapshot directly from mapped memory
+    uchar *data = file.map(0, file.size());
+    if (data == nullptr)
+        return {};
+
+    QByteArray mappedData = QByteArray::fromRawData(reinterpret_cast<const char *>(data), static_cast<int>(file.size()));
+    QBuffer buffer(&mappedData);
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream stream(&buffer);
+
+    quint32 magic;
+    quint32 version;
+    QByteArray snapshotKey;
+    stream >> magic >> version >> snapshotKey;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || snapshotKey != key)
+        return {};
+
+    qint32 count;
+    stream >> count;
+
+    QSharedPointer<PackagesTable> table(new PackagesTable);
+    table->reserve(count);
+    QVector<Package *> packages;
+    packages.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto *package = new Package;
+        package->setTableRow(table, table->readRow(stream));
+        packages.append(package);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "Packages snapshot is corrupted";
+        qDeleteAll(packages);
+        return {};
+    }
+
+    return packages;
+}
+
+void PackagesSnapshot::save(const QVector<Package *> &packages, const QByteArray &key)
+{
+    QDir().mkpath(QFileInfo(fileName()).path());
+
+    QSaveFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << key << static_cast<qint32>(packages.size());
+    foreach (const Package *package, packages)
+        PackagesTable::writeRow(stream, *package);
+
+    file.commit();
+}
+
+QString PackagesSnapshot::fileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/packages.snapshot";
+}
@@ -0,0 +1,21 @@
+#ifndef PACKAGESSNAPSHOT_H
+#define PACKAGESSNAPSHOT_H
+
+#include <QVector>
+
+class Package;
+class PacmanSettings;
+
+// Binary copy of the merged packages list to display it on startup before ALPM databases are loaded
+class PackagesSnapshot
+{
+public:
+    static QByteArray databasesKey(const PacmanSettings &settings);
+    static QVector<Package *> load(const QByteArray &key);
+    static void save(const QVector<Package *> &packages, const QByteArray &key);
+
+private:
+    static QString fileName();
+};
+
+#endif // PACKAGESSNAPSHOT_H
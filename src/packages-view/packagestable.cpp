@@ -0,0 +1,133 @@
+#include "packagestable.h"
+#include "package.h"
+
+#include <QDataStream>
+
+void PackagesTable::reserve(int size)
+{
+    m_names.reserve(size);
+    m_versions.reserve(size);
+    m_parsedVersions.reserve(size);
+    m_descriptions.reserve(size);
+    m_availableUpdates.reserve(size);
+    m_installedSizes.reserve(size);
+    m_repos.reserve(size);
+    m_installed.reserve(size);
+    m_installedExplicitly.reserve(size);
+}
+
+int PackagesTable::size() const
+{
+    return m_names.size();
+}
+
+int PackagesTable::append(const Package &package)
+{
+    return append(package.name(),
+                  package.version(),
+                  package.description(),
+                  package.repo(),
+                  package.availableUpdate(),
+                  package.installedSize(),
+                  package.isInstalled(),
+                  package.isInstalledExplicitly());
+}
+
+int PackagesTable::readRow(QDataStream &stream)
+{
+    QString name;
+    QString version;
+    QString description;
+    QString repo;
+    QString availableUpdate;
+    qint64 installedSize;
+    bool installed;
+    bool installedExplicitly;
+    stream >> name >> version >> description >> repo >> availableUpdate >> installedSize >> installed >> installedExplicitly;
+
+    return append(name, version, description, repo, availableUpdate, installedSize, installed, installedExplicitly);
+}
+
+void PackagesTable::writeRow(QDataStream &stream, const Package &package)
+{
+    stream << package.name()
+           << package.version()
+           << package.description()
+           << package.repo()
+           << package.availableUpdate()
+           << static_cast<qint64>(package.installedSize())
+           << package.isInstalled()
+           << package.isInstalledExplicitly();
+}
+
+const QString &PackagesTable::name(int id) const
+{
+    return m_names.at(id);
+}
+
+const QString &PackagesTable::version(int id) const
+{
+    return m_versions.at(id);
+}
+
+const PackageVersion &PackagesTable::parsedVersion(int id) const
+{
+    return m_parsedVersions.at(id);
+}
+
+const QString &PackagesTable::description(int id) const
+{
+    return m_descriptions.at(id);
+}
+
+const QString &PackagesTable::repo(int id) const
+{
+    return m_repoNames.at(m_repos.at(id));
+}
+
+const QString &PackagesTable::availableUpdate(int id) const
+{
+    return m_availableUpdates.at(id);
+}
+
+qint64 PackagesTable::installedSize(int id) const
+{
+    return m_installedSizes.at(id);
+}
+
+bool PackagesTable::isInstalled(int id) const
+{
+    return m_installed.at(id);
+}
+
+bool PackagesTable::isInstalledExplicitly(int id) const
+{
+    return m_installedExplicitly.at(id);
+}
+
+int PackagesTable::append(const QString &name, const QString &version, const QString &description, const QString &repo,
+                          const QString &availableUpdate, qint64 installedSize, bool installed, bool installedExplicitly)
+{
+    m_names.append(name);
+    m_versions.append(version);
+    m_parsedVersions.append(PackageVersion(version));
+    m_descriptions.append(description);
+    m_availableUpdates.append(availableUpdate);
+    m_installedSizes.append(installedSize);
+    m_repos.append(internRepo(repo));
+    m_installed.append(installed);
+    m_installedExplicitly.append(installedExplicitly);
+
+    return m_names.size() - 1;
+}
+
+quint16 PackagesTable::internRepo(const QString &repo)
+{
+    int index = m_repoNames.indexOf(repo);
+    if (index == -1) {
+        m_repoNames.append(repo);
+        index = m_repoNames.size() - 1;
+    }
+
+    return static_cast<quint16>(index);
+}
@@ -0,0 +1,55 @@
+#ifndef PACKAGESTABLE_H
+#define PACKAGESTABLE_H
+
+#include "packageversion.h"
+
+#include <QStringList>
+#include <QVector>
+
+class Package;
+class QDataStream;
+
+// Package fields used by the packages list, decoded once and stored by columns
+class PackagesTable
+{
+public:
+    void reserve(int size);
+    int size() const;
+
+    // Add row with fields of a package and return its id
+    int append(const Package &package);
+
+    // Rows of packages snapshot
+    int readRow(QDataStream &stream);
+    static void writeRow(QDataStream &stream, const Package &package);
+
+    const QString &name(int id) const;
+    const QString &version(int id) const;
+    const PackageVersion &parsedVersion(int id) const;
+    const QString &description(int id) const;
+    const QString &repo(int id) const;
+    const QString &availableUpdate(int id) const;
+    qint64 installedSize(int id) const;
+    bool isInstalled(int id) const;
+    bool isInstalledExplicitly(int id) const;
+
+private:
+    int append(const QString &name, const QString &version, const QString &description, const QString &repo,
+               const QString &availableUpdate, qint64 installedSize, bool installed, bool installedExplicitly);
+    quint16 internRepo(const QString &repo);
+
+    QVector<QString> m_names;
+    QVector<QString> m_versions;
+    QVector<PackageVersion> m_parsedVersions;
+    QVector<QString> m_descriptions;
+    QVector<QString> m_availableUpdates;
+    QVector<qint64> m_installedSizes;
+    QVector<quint16> m_repos;
+    QVector<bool> m_installed;
+    QVector<bool> m_installedExplicitly;
+
+    // Repository names are shared by all packages
+    QStringList m_repoNames;
+};
+
+#endif // PACKAGESTABLE_H
@@ -20,6 +20,7 @@ PackagesView::PackagesView(QWidget *parent) :
     m_markAsDependAction = m_menu->addAction(Task::categoryIcon(Task::MarkAsDepend), Task::categoryName(Task::MarkAsDepend));
     m_uninstallAction = m_menu->addAction(Task::categoryIcon(Task::Uninstall), Task::categoryName(Task::Uninstall));
     m_uninstallWithUnusedAction = m_menu->addAction(Task::categoryIcon(Task::UninstallWithUnused), Task::categoryName(Task::UninstallWithUnused));
+    m_uninstallOrphansAction = m_menu->addAction(Task::categoryIcon(Task::UninstallWithUnused), tr("Uninstall all orphans"));
     m_menu->addSeparator();
     m_syncAction = m_menu->addAction(Task::categoryIcon(Task::Sync), Task::categoryName(Task::Sync));
     m_upgradeAllAction = m_menu->addAction(Task::categoryIcon(Task::UpgradeAll), Task::categoryName(Task::UpgradeAll));
@@ -31,6 +32,9 @@ PackagesView::PackagesView(QWidget *parent) :
     header()->setSectionResizeMode(QHeaderView::ResizeToContents);
     connect(selectionModel(), &QItemSelectionModel::currentChanged, this, &PackagesView::processSelectionChanging);
     connect(model(), &PackagesModel::modelAboutToBeReset, this, &PackagesView::clearAllOperations);
+    connect(model(), &PackagesModel::rowsAboutToBeRemoved, this, &PackagesView::processRowsRemoving);
+    connect(model(), &PackagesModel::packagesRemoved, this, &PackagesView::processPackagesRemoving);
+    connect(this, &PackagesView::operationsCountChanged, this, &PackagesView::calculateRemovalImpact);
 
     // Emit current package changed signal on data change
     connect(model(), &PackagesModel::packageChanged, [&](Package *package) {
@@ -58,34 +62,40 @@ void PackagesView::search(const QString &text, PackagesView::SearchType type)
         }
     }
 
-    if (text.isEmpty()) {
-        if (!m_filtered)
-            return;
+    // Find owners of files
+    if (type == Files) {
+        model()->setFileFilter(text);
+        return;
+    }
 
-        // Show all repo packages
-        for (int i = 0; i < model()->packages().count(); ++i)
-            setRowHidden(i, QModelIndex(), false);
-        m_filtered = false;
+    // Search among installed dependencies that are no longer needed
+    if (type == Orphans) {
+        const AppSettings settings;
+        model()->setOrphansFilter(text.split(' ', QString::SkipEmptyParts), settings.isOptdependsRequired());
         return;
     }
 
     // Filter local packages
+    PackagesIndex::Fields fields;
     switch (type) {
     case Name:
-        filterPackages(text, &Package::name);
+        fields = PackagesIndex::Name;
         break;
     case NameDescription:
-        filterPackages(text, &Package::name, &Package::description);
+        fields = PackagesIndex::Name | PackagesIndex::Description;
         break;
     case Maintainer:
-        filterPackages(text, &Package::maintainer);
+        fields = PackagesIndex::Maintainer;
         break;
     case Description:
-        filterPackages(text, &Package::description);
+        fields = PackagesIndex::Description;
+        break;
+    case Files:
+    case Orphans:
         break;
     }
 
-    m_filtered = true;
+    model()->setFilter(text.split(' ', QString::SkipEmptyParts), fields);
 }
 
 bool PackagesView::find(const QString &packageName)
@@ -93,28 +103,32 @@ bool PackagesView::find(const QString &packageName)
     clearSelection();
 
     // Search by name
-    for (int i = 0; i < model()->packages().count(); ++i) {
-        if (model()->packages().at(i)->name() == packageName) {
-            const QModelIndex index = model()->index(i, 0);
+    const Package *package = model()->findPackage(packageName);
+    if (package != nullptr) {
+        const QModelIndex index = model()->packageIndex(package);
+        if (index.isValid()) {
             setCurrentIndex(index);
             scrollTo(index);
             return true;
         }
     }
 
-    // If not dound, then search by providing
-    for (int i = 0; i < model()->packages().count(); ++i) {
-        foreach (const Depend &depend, model()->packages().at(i)->provides()) {
-            if (depend.name() == packageName) {
-                const QModelIndex index = model()->index(i, 0);
-                setCurrentIndex(index);
-                scrollTo(index);
-                return true;
-            }
+    // If not found, then select all providing packages
+    bool found = false;
+    foreach (const Package *provider, model()->findProviders(packageName)) {
+        const QModelIndex index = model()->packageIndex(provider);
+        if (!index.isValid())
+            continue;
+
+        if (!found) {
+            setCurrentIndex(index);
+            scrollTo(index);
+            found = true;
         }
+        selectionModel()->select(index, QItemSelectionModel::Select | QItemSelectionModel::Rows);
     }
 
-    return false;
+    return found;
 }
 
 Package *PackagesView::currentPackage() const
@@ -207,6 +221,22 @@ int PackagesView::operationsCount()
     return count;
 }
 
+void PackagesView::clearAllOperations()
+{
+    m_upgradePackages = false;
+    m_syncRepositories = false;
+
+    m_installExplicity.clear();
+    m_installAsDepend.clear();
+    m_reinstall.clear();
+    m_markAsExplicity.clear();
+    m_markAsDepend.clear();
+    m_uninstall.clear();
+    m_uninstallWithUnused.clear();
+
+    emit operationsCountChanged(0);
+}
+
 void PackagesView::removeOperation(Task *task)
 {
     switch (task->type()) {
@@ -272,6 +302,8 @@ void PackagesView::removeOperation(Task *task)
 void PackagesView::processSelectionChanging(const QModelIndex &current)
 {
     auto *package = static_cast<Package *>(current.internalPointer());
+    if (package == nullptr)
+        return;
 
     // Load additional AUR info
     if (model()->mode() == PackagesModel::AUR)
@@ -300,22 +332,37 @@ void PackagesView::processMenuAction(QAction *action)
         addCurrentToTasks(m_uninstall);
     else if (action == m_uninstallWithUnusedAction)
         addCurrentToTasks(m_uninstallWithUnused);
+    else if (action == m_uninstallOrphansAction)
+        addOrphansToTasks();
 }
 
-void PackagesView::clearAllOperations()
+// Packages of removed rows are deleted, so remove them from operations
+void PackagesView::processRowsRemoving(const QModelIndex &parent, int first, int last)
 {
-    m_upgradePackages = false;
-    m_syncRepositories = false;
+    for (int row = first; row <= last; ++row)
+        removeFromTasks(static_cast<Package *>(model()->index(row, 0, parent).internalPointer()));
 
-    m_installExplicity.clear();
-    m_installAsDepend.clear();
-    m_reinstall.clear();
-    m_markAsExplicity.clear();
-    m_markAsDepend.clear();
-    m_uninstall.clear();
-    m_uninstallWithUnused.clear();
+    emit operationsCountChanged(operationsCount());
+}
 
-    emit operationsCountChanged(0);
+void PackagesView::processPackagesRemoving(const QSet<Package *> &packages)
+{
+    foreach (Package *package, packages)
+        removeFromTasks(package);
+
+    emit operationsCountChanged(operationsCount());
+}
+
+void PackagesView::calculateRemovalImpact()
+{
+    QStringList uninstall;
+    foreach (const Package *package, m_uninstall)
+        uninstall.append(package->name());
+    QStringList uninstallWithUnused;
+    foreach (const Package *package, m_uninstallWithUnused)
+        uninstallWithUnused.append(package->name());
+
+    model()->calculateRemovalImpact(uninstall, uninstallWithUnused);
 }
 
 void PackagesView::contextMenuEvent(QContextMenuEvent *event)
@@ -356,6 +403,10 @@ void PackagesView::contextMenuEvent(QContextMenuEvent *event)
     m_uninstallWithUnusedAction->setEnabled(!m_uninstallWithUnused.contains(package));
     m_syncAction->setEnabled(!m_syncRepositories);
 
+    // Orphans are removed with their unused dependencies like pacman -Rs $(pacman -Qdtq)
+    const AppSettings settings;
+    m_uninstallOrphansAction->setEnabled(!model()->orphans(settings.isOptdependsRequired()).isEmpty());
+
     // Enable the upgrade option only if upgrades are available or if the sync action is selected
     if ((!model()->outdatedPackages().isEmpty() || m_syncRepositories) && !m_upgradePackages)
         m_upgradeAllAction->setEnabled(true);
@@ -363,7 +414,6 @@ void PackagesView::contextMenuEvent(QContextMenuEvent *event)
         m_upgradeAllAction->setEnabled(false);
 
     // Disable install operations for AUR for pacman
-    const AppSettings settings;
     if (!package->isInstalled() && package->repo() == "aur" && settings.pacmanTool() == AppSettings::defaultPacmanTool()) {
         m_installExplicityAction->setEnabled(false);
         m_installAsDependAction->setEnabled(false);
@@ -389,6 +439,17 @@ void PackagesView::addCurrentToTasks(QVector<Package *> &category)
     emit operationsCountChanged(operationsCount());
 }
 
+void PackagesView::addOrphansToTasks()
+{
+    const AppSettings settings;
+    foreach (Package *package, model()->orphans(settings.isOptdependsRequired())) {
+        removeFromTasks(package);
+        m_uninstallWithUnused.append(package);
+    }
+
+    emit operationsCountChanged(operationsCount());
+}
+
 void PackagesView::removeFromTasks(Package *package)
 {
     if (m_installExplicity.removeOne(package))
@@ -406,24 +467,8 @@ void PackagesView::removeFromTasks(Package *package)
     if (m_markAsDepend.removeOne(package))
         return;
 
-    m_uninstall.removeOne(package);
-}
+    if (m_uninstall.removeOne(package))
+        return;
 
-template<class... T>
-void PackagesView::filterPackages(const QString &text, T... packagesMembers)
-{
-    const QStringList splittedText = text.split(' ', QString::SkipEmptyParts);
-    for (int i = 0; i < model()->packages().size(); ++i) {
-        const Package *package = model()->packages().at(i);
-
-        // Use narrow search
-        bool found = true;
-        foreach (const QString &textPart, splittedText) {
-            if ((!(package->*packagesMembers)().contains(textPart) && ...)) {
-                found = false;
-                break;
-            }
-        }
-        setRowHidden(i, QModelIndex(), !found);
-    }
+    m_uninstallWithUnused.removeOne(package);
 }
@@ -17,7 +17,9 @@ public:
         NameDescription,
         Name,
         Maintainer,
-        Description
+        Description,
+        Files,
+        Orphans
     };
 
     explicit PackagesView(QWidget *parent = nullptr);
@@ -43,6 +45,7 @@ public:
     void setSyncRepositories(bool isSyncRepositories);
 
     int operationsCount();
+    void clearAllOperations();
 
 public slots:
     void removeOperation(Task *task);
@@ -54,18 +57,18 @@ signals:
 private slots:
     void processSelectionChanging(const QModelIndex &current);
     void processMenuAction(QAction *action);
-    void clearAllOperations();
+    void processRowsRemoving(const QModelIndex &parent, int first, int last);
+    void processPackagesRemoving(const QSet<Package *> &packages);
+    void calculateRemovalImpact();
 
 private:
     void contextMenuEvent(QContextMenuEvent *event) override;
     void setModel(QAbstractItemModel *model) override;
 
     void addCurrentToTasks(QVector<Package *> &category);
+    void addOrphansToTasks();
     void removeFromTasks(Package *package);
 
-    template<class... T>
-    void filterPackages(const QString &text, T... packagesMembers);
-
     // Context menu actions
     QAction *m_installExplicityAction;
     QAction *m_installAsDependAction;
@@ -76,6 +79,7 @@ private:
     QAction *m_syncAction;
     QAction *m_upgradeAllAction;
     QAction *m_uninstallWithUnusedAction;
+    QAction *m_uninstallOrphansAction;
 
     // Packages operations
     QVector<Package *> m_installExplicity;
@@ -88,7 +92,6 @@ private:
     bool m_upgradePackages = false;
     bool m_syncRepositories = false;
 
-    bool m_filtered = false;
     QMenu *m_menu;
 };
 
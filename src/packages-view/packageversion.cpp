@@ -0,0 +1,193 @@
+#include "packageversion.h"
+
+#include <QString>
+
+// Character classes of the C locale used by rpmvercmp
+static bool isDigit(char character)
+{
+    return character >= '0' && character <= '9';
+}
+
+static bool isAlpha(char character)
+{
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+}
+
+static bool isAlnum(char character)
+{
+    return isDigit(character) || isAlpha(character);
+}
+
+// Split [epoch:]version[-release]
+PackageVersion::PackageVersion(const QString &version)
+{
+    const QByteArray text = version.toUtf8();
+
+    int epochEnd = 0;
+    while (epochEnd < text.size() && isDigit(text.at(epochEnd)))
+        ++epochEnd;
+
+    int versionStart = 0;
+    if (epochEnd < text.size() && text.at(epochEnd) == ':') {
+        m_epoch = parseSegments(epochEnd == 0 ? QByteArrayLiteral("0") : text.left(epochEnd));
+        versionStart = epochEnd + 1;
+    } else {
+        m_epoch = parseSegments(QByteArrayLiteral("0"));
+    }
+
+    const int releaseSeparator = text.lastIndexOf('-');
+    if (releaseSeparator >= versionStart) {
+        m_version = parseSegments(text.mid(versionStart, releaseSeparator - versionStart));
+        m_release = parseSegments(text.mid(releaseSeparator + 1));
+        m_hasRelease = true;
+    } else {
+        m_version = parseSegments(text.mid(versionStart));
+    }
+}
+
+// Release is compared only if both versions have it
+int PackageVersion::compare(const PackageVersion &first, const PackageVersion &second)
+{
+    int result = compareSegments(first.m_epoch, second.m_epoch);
+    if (result != 0)
+        return result;
+
+    result = compareSegments(first.m_version, second.m_version);
+    if (result != 0 || !first.m_hasRelease || !second.m_hasRelease)
+        return result;
+
+    return compareSegments(first.m_release, second.m_release);
+}
+
+bool PackageVersion::operator==(const PackageVersion &other) const
+{
+    return compare(*this, other) == 0;
+}
+
+bool PackageVersion::operator!=(const PackageVersion &other) const
+{
+    return compare(*this, other) != 0;
+}
+
+bool PackageVersion::operator<(const PackageVersion &other) const
+{
+    return compare(*this, other) < 0;
+}
+
+bool PackageVersion::operator>(const PackageVersion &other) const
+{
+    return compare(*this, other) > 0;
+}
+
+// Tokenize to alphabetic and numeric segments with the number of separators before each one
+PackageVersion::Segments PackageVersion::parseSegments(const QByteArray &text)
+{
+    Segments segments;
+    int position = 0;
+    while (position < text.size()) {
+        Segment segment;
+        while (position < text.size() && !isAlnum(text.at(position))) {
+            ++position;
+            ++segment.separators;
+        }
+
+        if (position == text.size()) {
+            segment.type = End;
+            segments.append(segment);
+            break;
+        }
+
+        const int start = position;
+        if (isDigit(text.at(position))) {
+            while (position < text.size() && isDigit(text.at(position)))
+                ++position;
+
+            // Leading zeros are ignored
+            int significantStart = start;
+            while (significantStart < position && text.at(significantStart) == '0')
+                ++significantStart;
+
+            segment.type = Numeric;
+            segment.text = text.mid(significantStart, position - significantStart);
+        } else {
+            while (position < text.size() && isAlpha(text.at(position)))
+                ++position;
+
+            segment.type = Alpha;
+            segment.text = text.mid(start, position - start);
+        }
+        segments.append(segment);
+    }
+
+    return segments;
+}
+
+// Same as rpmvercmp from libalpm, but on already parsed segments
+int PackageVersion::compareSegments(const Segments &first, const Segments &second)
+{
+    int index = 0;
+    bool separatorsSkipped = false;
+    while (index < first.size() && index < second.size()) {
+        const Segment &firstSegment = first.at(index);
+        const Segment &secondSegment = second.at(index);
+
+        // Ran to the end of one of versions
+        if (firstSegment.type == End || secondSegment.type == End) {
+            separatorsSkipped = true;
+            break;
+        }
+
+        if (firstSegment.separators != secondSegment.separators)
+            return firstSegment.separators < secondSegment.separators ? -1 : 1;
+
+        // Numeric segment is always newer than alphabetic
+        if (firstSegment.type != secondSegment.type)
+            return firstSegment.type == Numeric ? 1 : -1;
+
+        // Longer number is bigger
+        if (firstSegment.type == Numeric && firstSegment.text.size() != secondSegment.text.size())
+            return firstSegment.text.size() < secondSegment.text.size() ? -1 : 1;
+
+        const int result = qstrcmp(firstSegment.text, secondSegment.text);
+        if (result != 0)
+            return result < 0 ? -1 : 1;
+
+        ++index;
+    }
+
+    // Classify the first remaining character of each version
+    enum Rest {
+        Empty,
+        Letter,
+        Other
+    };
+    const auto rest = [index, separatorsSkipped](const Segments &segments) {
+        if (index >= segments.size())
+            return Empty;
+
+        const Segment &segment = segments.at(index);
+        if (!separatorsSkipped && segment.separators > 0)
+            return Other;
+
+        switch (segment.type) {
+        case Alpha:
+            return Letter;
+        case Numeric:
+            return Other;
+        case End:
+            return Empty;
+        }
+        return Empty;
+    };
+    const Rest firstRest = rest(first);
+    const Rest secondRest = rest(second);
+
+    if (firstRest == Empty && secondRest == Empty)
+        return 0;
+
+    // Remaining alphabetic segment should never beat an empty string
+    if ((firstRest == Empty && secondRest != Letter) || firstRest == Letter)
+        return -1;
+
+    return 1;
+}
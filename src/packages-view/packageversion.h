@@ -0,0 +1,45 @@
+#ifndef PACKAGEVERSION_H
+#define PACKAGEVERSION_H
+
+#include <QVector>
+#include <QByteArray>
+
+class QString;
+
+// Version split into epoch, version and release segments once to compare it like alpm_pkg_vercmp
+class PackageVersion
+{
+public:
+    PackageVersion() = default;
+    explicit PackageVersion(const QString &version);
+
+    static int compare(const PackageVersion &first, const PackageVersion &second);
+
+    bool operator==(const PackageVersion &other) const;
+    bool operator!=(const PackageVersion &other) const;
+    bool operator<(const PackageVersion &other) const;
+    bool operator>(const PackageVersion &other) const;
+
+private:
+    enum SegmentType : quint8 {
+        Numeric,
+        Alpha,
+        End // Trailing separators
+    };
+    struct Segment {
+        QByteArray text;
+        int separators = 0;
+        SegmentType type = End;
+    };
+    using Segments = QVector<Segment>;
+
+    static Segments parseSegments(const QByteArray &text);
+    static int compareSegments(const Segments &first, const Segments &second);
+
+    Segments m_epoch;
+    Segments m_version;
+    Segments m_release;
+    bool m_hasRelease = false;
+};
+
+#endif // PACKAGEVERSION_H
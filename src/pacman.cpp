@@ -25,40 +25,42 @@ void Pacman::setTasks(PackagesView *view)
     m_tasksView = view;
 }
 
-QString Pacman::tasksCommands()
+// Compatible tasks are merged to resolve dependencies and lock the database as few times as possible
+QStringList Pacman::tasksCommands()
 {
     const AppSettings settings;
     const QString pacmanTool = settings.pacmanTool();
-    QString commands;
-
-    if (m_tasksView->isSyncRepositories() && m_tasksView->isUpgradePackages()) {
-        commands.append(pacmanTool);
-        commands.append(" -Syu");
-        if (m_noConfirm)
-            commands.append(" --noconfirm");
-        if (m_force)
-            commands.append(" --force");
-    } else {
-        if (m_tasksView->isSyncRepositories()) {
-            commands.append(pacmanTool);
-            commands.append(" -Sy");
-        }
+    QStringList commands;
 
-        if (m_tasksView->isUpgradePackages()) {
-            commands.append(pacmanTool);
-            commands.append(" -Su");
-            if (m_noConfirm)
-                commands.append(" --noconfirm");
-            if (m_force)
-                commands.append(" --force");
+    QString syncAction = QStringLiteral(" -S");
+    if (m_tasksView->isSyncRepositories())
+        syncAction.append('y');
+    if (m_tasksView->isUpgradePackages())
+        syncAction.append('u');
+
+    // Dependencies flag applies to every package in the transaction, so install reason is changed after mixed installation
+    const QVector<Package *> install = m_tasksView->installExplicity() + m_tasksView->reinstall();
+    const QVector<Package *> installAsDepend = m_tasksView->installAsDepend();
+    QVector<Package *> markAsDepend = m_tasksView->markAsDepend();
+    if (m_tasksView->isUpgradePackages() || !install.isEmpty()) {
+        if (install.isEmpty() && installAsDepend.isEmpty()) {
+            QString command = pacmanTool + syncAction;
+            appendParameters(command);
+            commands.append(command);
+        } else {
+            appendPackagesCommand(commands, pacmanTool, install + installAsDepend, syncAction);
+            markAsDepend = installAsDepend + markAsDepend;
         }
+    } else if (!installAsDepend.isEmpty()) {
+        appendPackagesCommand(commands, pacmanTool, installAsDepend, syncAction, " --asdeps");
+    } else if (m_tasksView->isSyncRepositories()) {
+        commands.append(pacmanTool + syncAction);
     }
 
-    appendPackagesCommand(commands, pacmanTool, m_tasksView->installExplicity(), " -S");
-    appendPackagesCommand(commands, pacmanTool, m_tasksView->installAsDepend(), " -S", " --asdeps");
-    appendPackagesCommand(commands, pacmanTool, m_tasksView->reinstall(), " -S");
     appendPackagesCommand(commands, pacmanTool, m_tasksView->markAsExplicit(), " -D", " --asexplicit");
-    appendPackagesCommand(commands, pacmanTool, m_tasksView->markAsDepend(), " -D", " --asdeps");
+    appendPackagesCommand(commands, pacmanTool, markAsDepend, " -D", " --asdeps");
+
+    // Recursive flag also applies to all targets, so removals with and without unused dependencies stay separate
     appendPackagesCommand(commands, pacmanTool, m_tasksView->uninstall(), " -R");
     appendPackagesCommand(commands, pacmanTool, m_tasksView->uninstallWithUnused(), " -Rs");
 
@@ -69,7 +71,7 @@ void Pacman::executeTasks()
 {
     if (m_tasksView->isSyncRepositories())
         m_updateTimeOnSuccess = true;
-    exec(tasksCommands(), m_afterTasksCompletion);
+    exec(tasksCommands().join(" && "), m_afterTasksCompletion);
 }
 
 void Pacman::installLocalPackage(const QString &fileName, bool asDepend)
@@ -141,27 +143,27 @@ void Pacman::getExitCode()
     errorFile.remove();
 }
 
-void Pacman::appendPackagesCommand(QString &commands, const QString &pacmanTool, const QVector<Package *> &packages, const QString &action, const QString &parameters)
+void Pacman::appendPackagesCommand(QStringList &commands, const QString &pacmanTool, const QVector<Package *> &packages, const QString &action, const QString &parameters)
 {
     if (packages.isEmpty())
         return;
 
-    if (!commands.isEmpty())
-        commands.append(" && ");
-
-    commands.append(pacmanTool);
-    commands.append(action);
-
+    QString command = pacmanTool + action;
     foreach (Package *package, packages)
-        commands.append(' ' + package->name());
+        command.append(' ' + package->name());
 
-    commands.append(parameters);
+    command.append(parameters);
+    appendParameters(command);
+    commands.append(command);
+}
 
+void Pacman::appendParameters(QString &command) const
+{
     if (m_noConfirm)
-        commands.append(" --noconfirm");
+        command.append(" --noconfirm");
 
     if (m_force)
-        commands.append(" --force");
+        command.append(" --force");
 }
 
 QString Pacman::afterCompletionCommand(AfterCompletion afterCompletion)
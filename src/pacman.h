@@ -2,7 +2,7 @@
 #define PACMAN_H
 
 #include <QObject>
-#include <QString>
+#include <QStringList>
 
 class QProcess;
 class PackagesView;
@@ -25,7 +25,7 @@ public:
 
     // Actions
     void setTasks(PackagesView *view);
-    QString tasksCommands();
+    QStringList tasksCommands();
     void executeTasks();
 
     void installLocalPackage(const QString &fileName, bool asDepend = false);
@@ -49,7 +49,8 @@ private slots:
     void getExitCode();
 
 private:
-    void appendPackagesCommand(QString &tasksCommands, const QString &pacmanTool, const QVector<Package *> &packages, const QString &action, const QString &parameters = QString());
+    void appendPackagesCommand(QStringList &tasksCommands, const QString &pacmanTool, const QVector<Package *> &packages, const QString &action, const QString &parameters = QString());
+    void appendParameters(QString &command) const;
     static QString afterCompletionCommand(AfterCompletion afterCompletion);
     void exec(const QString &commands, AfterCompletion afterCompletion);
 
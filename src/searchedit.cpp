@@ -3,8 +3,14 @@
 
 #include <QTimer>
 
+constexpr int MIN_EDIT_INTERVAL = 50;
+constexpr int MAX_EDIT_INTERVAL = 500;
+constexpr int DEFAULT_SEARCH_DURATION = 75;
+
 SearchEdit::SearchEdit(QWidget *parent) :
-    QLineEdit(parent)
+    QLineEdit(parent),
+    m_searchDuration(DEFAULT_SEARCH_DURATION),
+    m_editInterval(MIN_EDIT_INTERVAL + DEFAULT_SEARCH_DURATION * 2)
 {
     m_timer = new QTimer(this);
     m_timer->setSingleShot(true);
@@ -23,9 +29,16 @@ void SearchEdit::setInstantSearchEnabled(bool enabled)
     }
 }
 
+// Wait longer between keystrokes when searches are slow (AUR requests) and react faster when they are cheap
+void SearchEdit::setSearchDuration(qint64 elapsed)
+{
+    m_searchDuration = (m_searchDuration * 3 + elapsed) / 4;
+    m_editInterval = static_cast<int>(qBound<qint64>(MIN_EDIT_INTERVAL, MIN_EDIT_INTERVAL + m_searchDuration * 2, MAX_EDIT_INTERVAL));
+}
+
 void SearchEdit::waitEditInterval()
 {
-    m_timer->start(200);
+    m_timer->start(m_editInterval);
 }
 
 void SearchEdit::processTextChanged()
@@ -12,6 +12,7 @@ public:
     SearchEdit(QWidget *parent = nullptr);
 
     void setInstantSearchEnabled(bool enabled);
+    void setSearchDuration(qint64 elapsed);
 
 signals:
     void textSearched(const QString &searchText);
@@ -22,6 +23,8 @@ private slots:
 
 private:
     QTimer *m_timer;
+    qint64 m_searchDuration;
+    int m_editInterval;
 };
 
 #endif // SEARCHEDIT_H
@@ -185,6 +185,7 @@ void SettingsDialog::accept()
     settings.setTerminal(ui->terminalComboBox->currentText());
     settings.setTerminalArguments(ui->terminalComboBox->currentText(), ui->terminalArgumentsEdit->text().split(' '));
     settings.setPacmanTool(ui->pacmanToolComboBox->currentText());
+    settings.setOptdependsRequired(ui->optdependsRequiredCheckBox->isChecked());
     settings.setAutosyncType(static_cast<AutosyncTimer::AutosyncType>(ui->autosyncButtonGroup->checkedId()));
     settings.setAutosyncTime(ui->autosyncTimeEdit->time());
     settings.setAutosyncInterval(ui->autosyncIntervalSpinBox->value());
@@ -201,6 +202,8 @@ void SettingsDialog::accept()
     settings.setProxyAuthEnabled(ui->proxyAuthCheckBox->isChecked());
     settings.setProxyUsername(ui->proxyUsernameEdit->text());
     settings.setProxyPassword(ui->proxyPasswordEdit->text());
+    settings.setOfflineAurSearchEnabled(ui->offlineAurSearchGroupBox->isChecked());
+    settings.setAurArchiveFile(ui->aurArchiveFileEdit->text());
 
     // Shortcuts
     settings.setChangeModeShortcut(ui->shortcutsTreeWidget->topLevelItem(0)->text(1));
@@ -221,6 +224,7 @@ void SettingsDialog::restoreDefaults()
     // Pacman settings
     ui->terminalComboBox->setCurrentIndex(0);
     ui->pacmanToolComboBox->setCurrentIndex(0);
+    ui->optdependsRequiredCheckBox->setChecked(AppSettings::defaultIsOptdependsRequired());
     ui->autosyncGroupBox->setChecked(true);
     ui->autosyncButtonGroup->buttons().at(AppSettings::defaultAutosyncType())->setChecked(true);
     ui->autosyncTimeEdit->setTime(AppSettings::defaultAutosyncTime());
@@ -238,6 +242,8 @@ void SettingsDialog::restoreDefaults()
     ui->proxyAuthCheckBox->setChecked(false);
     ui->proxyUsernameEdit->setText("");
     ui->proxyPasswordEdit->setText("");
+    ui->offlineAurSearchGroupBox->setChecked(AppSettings::defaultIsOfflineAurSearchEnabled());
+    ui->aurArchiveFileEdit->setText("");
 
     // Shortcuts
     on_resetAllShortcutsButton_clicked();
@@ -270,6 +276,7 @@ void SettingsDialog::loadSettings()
         ui->pacmanToolComboBox->setCurrentText(pacmanTool);
     else
         ui->pacmanToolComboBox->setCurrentIndex(pacmanToolIndex);
+    ui->optdependsRequiredCheckBox->setChecked(settings.isOptdependsRequired());
 
     // Autosync
     ui->autosyncButtonGroup->button(settings.autosyncType())->setChecked(true);
@@ -288,6 +295,8 @@ void SettingsDialog::loadSettings()
     ui->proxyAuthCheckBox->setChecked(settings.isProxyAuthEnabled());
     ui->proxyUsernameEdit->setText(settings.proxyUsername());
     ui->proxyPasswordEdit->setText(settings.proxyPassword());
+    ui->offlineAurSearchGroupBox->setChecked(settings.isOfflineAurSearchEnabled());
+    ui->aurArchiveFileEdit->setText(settings.aurArchiveFile());
 
     // Shortcuts
     ui->shortcutsTreeWidget->topLevelItem(0)->setText(1, settings.changeModeShortcut());
@@ -3,20 +3,25 @@
 #include "pacman.h"
 #include "tasks-view/tasksmodel.h"
 #include "packages-view/packagesview.h"
+#include "packages-view/package.h"
+#include "appsettings.h"
 
 #include <QPushButton>
 #include <QMenuBar>
+#include <QLocale>
 
 TasksDialog::TasksDialog(Pacman *terminal, PackagesView *view, QMenuBar *bar, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::TasksDialog),
     m_pacman(terminal),
-    m_packagesView(view)
+    m_packagesView(view),
+    m_simulator(new TransactionSimulator(this))
 {
     ui->setupUi(this);
     ui->tasksView->model()->setTasks(m_packagesView);
     ui->tasksView->expandAll();
     connect(m_packagesView, &PackagesView::operationsCountChanged, this, &TasksDialog::processTaskRemoving);
+    connect(m_simulator, &TransactionSimulator::finished, this, &TasksDialog::displayTransactionPlan);
 
     // Change OK button text and icon
     QPushButton *okButton = ui->buttonBox->button(QDialogButtonBox::Ok);
@@ -53,6 +58,7 @@ TasksDialog::~TasksDialog()
 int TasksDialog::exec()
 {
     updateCommandsText();
+    simulateTransaction();
     return QDialog::exec();
 }
 
@@ -82,9 +88,59 @@ void TasksDialog::processTaskRemoving()
         ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
 
     updateCommandsText();
+    simulateTransaction();
+}
+
+void TasksDialog::displayTransactionPlan(const TransactionSimulator::Plan &plan)
+{
+    const QLocale locale;
+    QString text;
+    if (!plan.install.isEmpty())
+        text += tr("Install (%1): %2").arg(plan.install.size()).arg(plan.install.join(", ")) + '\n';
+    if (!plan.foreign.isEmpty())
+        text += tr("Not resolved, built by %1 (%2): %3").arg(AppSettings().pacmanTool()).arg(plan.foreign.size()).arg(plan.foreign.join(", ")) + '\n';
+    if (!plan.dependencies.isEmpty())
+        text += tr("Pulled in dependencies (%1): %2").arg(plan.dependencies.size()).arg(plan.dependencies.join(", ")) + '\n';
+    if (!plan.remove.isEmpty())
+        text += tr("Remove (%1): %2").arg(plan.remove.size()).arg(plan.remove.join(", ")) + '\n';
+    if (plan.downloadSize > 0)
+        text += tr("Download size: %1").arg(locale.formattedDataSize(plan.downloadSize, 2, QLocale::DataSizeTraditionalFormat)) + '\n';
+    if (plan.sizeDelta != 0) {
+        text += tr("Net installed size: %1").arg(QString(plan.sizeDelta > 0 ? '+' : '-')
+                + locale.formattedDataSize(qAbs(plan.sizeDelta), 2, QLocale::DataSizeTraditionalFormat)) + '\n';
+    }
+    foreach (const QString &problem, plan.problems)
+        text += tr("Problem: %1").arg(problem) + '\n';
+
+    // Marking tasks and repositories synchronization change no packages
+    if (text.isEmpty())
+        text = tr("Nothing to resolve");
+
+    ui->transactionEdit->setPlainText(text.trimmed());
 }
 
 void TasksDialog::updateCommandsText()
 {
-    ui->commandsEdit->setPlainText(m_pacman->tasksCommands());
+    ui->commandsEdit->setPlainText(m_pacman->tasksCommands().join(" &&\n"));
+}
+
+// Repositories synchronization is not simulated, so current databases are used
+void TasksDialog::simulateTransaction()
+{
+    TransactionSimulator::Targets targets;
+    targets.upgrade = m_packagesView->isUpgradePackages();
+    foreach (const Package *package, m_packagesView->installExplicity() + m_packagesView->installAsDepend() + m_packagesView->reinstall()) {
+        // Packages outside sync databases are built by the pacman tool
+        if (package->repo() == "aur" || package->repo() == "local")
+            targets.foreignInstall.append(package->name());
+        else
+            targets.install.append(package->name());
+    }
+    foreach (const Package *package, m_packagesView->uninstall())
+        targets.uninstall.append(package->name());
+    foreach (const Package *package, m_packagesView->uninstallWithUnused())
+        targets.uninstallWithUnused.append(package->name());
+
+    ui->transactionEdit->setPlainText(QString());
+    m_simulator->simulate(targets);
 }
@@ -1,6 +1,8 @@
 #ifndef TASKSDIALOG_H
 #define TASKSDIALOG_H
 
+#include "transactionsimulator.h"
+
 #include <QDialog>
 
 class QMenuBar;
@@ -27,13 +29,16 @@ private slots:
     void setForce(bool enabled);
     void setAfterCompletion(int action);
     void processTaskRemoving();
+    void displayTransactionPlan(const TransactionSimulator::Plan &plan);
 
 private:
     void updateCommandsText();
+    void simulateTransaction();
 
     Ui::TasksDialog *ui;
     Pacman *m_pacman;
     PackagesView *m_packagesView;
+    TransactionSimulator *m_simulator;
 };
 
 #endif // TASKSDIALOG_H
@@ -0,0 +1,175 @@
+#include "transactionsimulator.h"
+#include "pacmansettings.h"
+
+#include <QtConcurrent>
+#include <QSet>
+
+#include <alpm.h>
+
+#include <functional>
+
+namespace {
+QString packageString(alpm_pkg_t *package)
+{
+    return QString::fromUtf8(alpm_pkg_get_name(package)) + ' ' + QString::fromUtf8(alpm_pkg_get_version(package));
+}
+
+QString dependString(alpm_depend_t *depend)
+{
+    char *string = alpm_dep_compute_string(depend);
+    const QString result = QString::fromUtf8(string);
+    free(string);
+    return result;
+}
+
+// Only prepares the transaction, so nothing is downloaded or changed and the database lock is not needed
+void simulateTransaction(alpm_handle_t *handle, int flags, const QSet<QString> &targetNames, TransactionSimulator::Plan &plan, const std::function<void()> &addTargets)
+{
+    if (alpm_trans_init(handle, flags | ALPM_TRANS_FLAG_NOLOCK) != 0) {
+        plan.problems.append(alpm_strerror(alpm_errno(handle)));
+        return;
+    }
+
+    addTargets();
+
+    alpm_list_t *data = nullptr;
+    if (alpm_trans_prepare(handle, &data) != 0) {
+        const alpm_errno_t error = alpm_errno(handle);
+        for (alpm_list_t *item = data; item != nullptr; item = item->next) {
+            switch (error) {
+            case ALPM_ERR_UNSATISFIED_DEPS: {
+                auto *missing = static_cast<alpm_depmissing_t *>(item->data);
+                plan.problems.append(QString::fromUtf8(missing->target) + " requires " + dependString(missing->depend));
+                alpm_depmissing_free(missing);
+                break;
+            }
+            case ALPM_ERR_CONFLICTING_DEPS: {
+                auto *conflict = static_cast<alpm_conflict_t *>(item->data);
+                plan.problems.append("Conflict with " + dependString(conflict->reason));
+                alpm_conflict_free(conflict);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        if (data == nullptr || (error != ALPM_ERR_UNSATISFIED_DEPS && error != ALPM_ERR_CONFLICTING_DEPS))
+            plan.problems.append(alpm_strerror(error));
+        alpm_list_free(data);
+        alpm_trans_release(handle);
+        return;
+    }
+
+    alpm_db_t *localDatabase = alpm_get_localdb(handle);
+    for (alpm_list_t *item = alpm_trans_get_add(handle); item != nullptr; item = item->next) {
+        auto *package = static_cast<alpm_pkg_t *>(item->data);
+        alpm_pkg_t *installedPackage = alpm_db_get_pkg(localDatabase, alpm_pkg_get_name(package));
+        plan.install.append(packageString(package));
+        if (installedPackage == nullptr && !targetNames.contains(QString::fromUtf8(alpm_pkg_get_name(package))))
+            plan.dependencies.append(packageString(package));
+
+        plan.downloadSize += alpm_pkg_download_size(package);
+        plan.sizeDelta += alpm_pkg_get_isize(package);
+        if (installedPackage != nullptr)
+            plan.sizeDelta -= alpm_pkg_get_isize(installedPackage);
+    }
+    for (alpm_list_t *item = alpm_trans_get_remove(handle); item != nullptr; item = item->next) {
+        auto *package = static_cast<alpm_pkg_t *>(item->data);
+        plan.remove.append(packageString(package));
+        plan.sizeDelta -= alpm_pkg_get_isize(package);
+    }
+
+    alpm_trans_release(handle);
+}
+}
+
+TransactionSimulator::TransactionSimulator(QObject *parent) :
+    QObject(parent)
+{
+}
+
+TransactionSimulator::~TransactionSimulator()
+{
+    m_simulating.waitForFinished();
+}
+
+// Only the latest targets are simulated if they change while the previous simulation is running
+void TransactionSimulator::simulate(const Targets &targets)
+{
+    ++m_generation;
+    m_pendingTargets = targets;
+    m_pending = true;
+    if (!m_simulating.isRunning())
+        startSimulation();
+}
+
+void TransactionSimulator::startSimulation()
+{
+    const Targets targets = m_pendingTargets;
+    const int generation = m_generation;
+    m_pending = false;
+    m_simulating = QtConcurrent::run([this, targets, generation] {
+        const Plan plan = simulateTargets(targets);
+        QMetaObject::invokeMethod(this, [this, plan, generation] {
+            if (m_pending)
+                startSimulation();
+            else if (generation == m_generation)
+                emit finished(plan);
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Uses own handle because transaction state is stored in the handle which is used by the GUI thread
+TransactionSimulator::Plan TransactionSimulator::simulateTargets(const Targets &targets)
+{
+    Plan plan;
+    plan.foreign = targets.foreignInstall;
+    const PacmanSettings settings;
+    alpm_errno_t error = ALPM_ERR_OK;
+    alpm_handle_t *handle = alpm_initialize(qPrintable(settings.rootDir()), qPrintable(settings.databasesPath()), &error);
+    if (error != ALPM_ERR_OK) {
+        plan.problems.append(alpm_strerror(error));
+        return plan;
+    }
+
+    // Cached packages are not counted in download size
+    alpm_option_add_cachedir(handle, qPrintable(settings.cacheDir()));
+    foreach (const QString &databaseName, settings.repositories())
+        alpm_register_syncdb(handle, qPrintable(databaseName), 0);
+
+    // Installation and upgrade are resolved together like pacman -Su with targets
+    if (targets.upgrade || !targets.install.isEmpty()) {
+        const QSet<QString> targetNames = targets.install.toSet();
+        simulateTransaction(handle, 0, targetNames, plan, [&] {
+            if (targets.upgrade && alpm_sync_sysupgrade(handle, 0) != 0)
+                plan.problems.append(alpm_strerror(alpm_errno(handle)));
+
+            foreach (const QString &packageName, targets.install) {
+                alpm_pkg_t *package = alpm_find_dbs_satisfier(handle, alpm_get_syncdbs(handle), qPrintable(packageName));
+                if (package == nullptr)
+                    plan.problems.append(packageName + " is not found in repositories");
+                else if (alpm_add_pkg(handle, package) != 0 && alpm_errno(handle) != ALPM_ERR_TRANS_DUP_TARGET)
+                    plan.problems.append(packageName + ": " + alpm_strerror(alpm_errno(handle)));
+            }
+        });
+    }
+
+    // Removal with unused dependencies is a separate pacman call with other flags
+    alpm_db_t *localDatabase = alpm_get_localdb(handle);
+    const auto removeTargets = [&](const QStringList &packageNames) {
+        foreach (const QString &packageName, packageNames) {
+            alpm_pkg_t *package = alpm_db_get_pkg(localDatabase, qPrintable(packageName));
+            if (package == nullptr)
+                plan.problems.append(packageName + " is not installed");
+            else if (alpm_remove_pkg(handle, package) != 0)
+                plan.problems.append(packageName + ": " + alpm_strerror(alpm_errno(handle)));
+        }
+    };
+    if (!targets.uninstall.isEmpty())
+        simulateTransaction(handle, 0, {}, plan, [&] { removeTargets(targets.uninstall); });
+    if (!targets.uninstallWithUnused.isEmpty())
+        simulateTransaction(handle, ALPM_TRANS_FLAG_RECURSE, {}, plan, [&] { removeTargets(targets.uninstallWithUnused); });
+
+    alpm_release(handle);
+    return plan;
+}
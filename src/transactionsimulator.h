@@ -0,0 +1,51 @@
+#ifndef TRANSACTIONSIMULATOR_H
+#define TRANSACTIONSIMULATOR_H
+
+#include <QObject>
+#include <QFuture>
+#include <QStringList>
+
+// Resolves queued tasks with libalpm without committing, like pacman --print
+class TransactionSimulator : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TransactionSimulator)
+
+public:
+    struct Targets {
+        bool upgrade = false;
+        QStringList install;
+        QStringList foreignInstall; // AUR packages, built by the pacman tool
+        QStringList uninstall;
+        QStringList uninstallWithUnused;
+    };
+
+    struct Plan {
+        QStringList install; // Names with versions
+        QStringList dependencies; // Pulled in packages, also present in install
+        QStringList foreign; // Not resolved, libalpm knows nothing about them
+        QStringList remove;
+        QStringList problems;
+        qint64 downloadSize = 0;
+        qint64 sizeDelta = 0;
+    };
+
+    explicit TransactionSimulator(QObject *parent = nullptr);
+    ~TransactionSimulator() override;
+
+    void simulate(const Targets &targets);
+
+signals:
+    void finished(const TransactionSimulator::Plan &plan);
+
+private:
+    void startSimulation();
+    static Plan simulateTargets(const Targets &targets);
+
+    QFuture<void> m_simulating;
+    Targets m_pendingTargets;
+    bool m_pending = false;
+    int m_generation = 0;
+};
+
+#endif // TRANSACTIONSIMULATOR_H